@@ -0,0 +1,384 @@
+#include "AstTreeModel.h"
+#include <algorithm>
+#include "ast.h"
+
+namespace {
+
+// 长列表每次创建的子项数，视图滚动到末尾时再取下一批
+constexpr int FETCH_BATCH = 256;
+
+// AST 中的文本是指向 Arena 的视图（不以'\0'结尾），显示前转换为 QString
+QString toQString(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), static_cast<int>(text.size()));
+}
+
+} // namespace
+
+// 树中的一项。AST 节点的子项按字段生成：字段有值时是一个标签项（如“初始化值：”）再挂上子节点，
+// 没有值时是一个说明文字项（如“无初始化值”）
+struct AstTreeModel::Item {
+    enum Kind {
+        Root,           // 不显示的根项
+        Text,           // 只有文字的叶子
+        Node,           // AST 节点
+        Slot,           // 字段标签，唯一的子项是 node
+        Statements,     // Program 的全局语句
+        Functions,      // Program 的函数定义
+        Params,         // 函数的参数
+        Call,           // 函数调用（CallExpr 不是 AST 节点）
+        Arguments,      // 函数调用的参数
+    };
+
+    Kind kind = Text;
+    QString text;
+    const ASTNode *node = nullptr;
+    const Program *program = nullptr;
+    const FunctionDef *function = nullptr;
+    const CallExpr *call = nullptr;
+
+    Item *parent = nullptr;
+    int row = 0;
+    bool complete = false;      // 子项已全部创建
+    std::vector<std::unique_ptr<Item>> children;
+
+    Item(Kind kind, QString text) : kind(kind), text(std::move(text)) {}
+
+    void append(std::unique_ptr<Item> child)
+    {
+        child->parent = this;
+        child->row = static_cast<int>(children.size());
+        children.push_back(std::move(child));
+    }
+};
+
+AstTreeModel::AstTreeModel(QObject *parent)
+    : QAbstractItemModel(parent), root(std::make_unique<Item>(Item::Root, QString()))
+{
+}
+
+AstTreeModel::~AstTreeModel() = default;
+
+void AstTreeModel::setSnapshot(std::shared_ptr<const CompileSnapshot> newSnapshot)
+{
+    beginResetModel();
+    snapshot = std::move(newSnapshot);
+    root = std::make_unique<Item>(Item::Root, QString());
+    root->complete = true;
+    if (snapshot && snapshot->program) {
+        auto top = std::make_unique<Item>(Item::Slot, "ast树");
+        top->node = snapshot->program.get();
+        root->append(std::move(top));
+    }
+    endResetModel();
+}
+
+void AstTreeModel::clear()
+{
+    setSnapshot(nullptr);
+}
+
+AstTreeModel::Item *AstTreeModel::itemAt(const QModelIndex &index) const
+{
+    return index.isValid() ? static_cast<Item *>(index.internalPointer()) : root.get();
+}
+
+QModelIndex AstTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    Item *parentItem = itemAt(parent);
+    if (column != 0 || row < 0 || row >= static_cast<int>(parentItem->children.size())) {
+        return QModelIndex();
+    }
+    return createIndex(row, 0, parentItem->children[row].get());
+}
+
+QModelIndex AstTreeModel::parent(const QModelIndex &index) const
+{
+    if (!index.isValid()) return QModelIndex();
+    Item *parentItem = itemAt(index)->parent;
+    if (!parentItem || parentItem == root.get()) return QModelIndex();
+    return createIndex(parentItem->row, 0, parentItem);
+}
+
+int AstTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) return 0;
+    return static_cast<int>(itemAt(parent)->children.size());
+}
+
+int AstTreeModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+bool AstTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    const Item *item = itemAt(parent);
+    return item->complete ? !item->children.empty() : mayHaveChildren(*item);
+}
+
+bool AstTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    const Item *item = itemAt(parent);
+    return !item->complete && mayHaveChildren(*item);
+}
+
+void AstTreeModel::fetchMore(const QModelIndex &parent)
+{
+    Item *item = itemAt(parent);
+    if (item->complete) return;
+
+    int size = listSize(*item);
+    if (size < 0) {
+        // 按字段生成子项的节点：子项很少，一次全部创建
+        Item fields(Item::Text, QString());
+        appendFields(*item, fields);
+        if (!fields.children.empty()) {
+            beginInsertRows(parent, 0, static_cast<int>(fields.children.size()) - 1);
+            for (auto &child : fields.children) item->append(std::move(child));
+            endInsertRows();
+        }
+        item->complete = true;
+        return;
+    }
+
+    int first = static_cast<int>(item->children.size());
+    int last = std::min(size, first + FETCH_BATCH) - 1;
+    if (last >= first) {
+        beginInsertRows(parent, first, last);
+        for (int i = first; i <= last; ++i) item->append(listChild(*item, i));
+        endInsertRows();
+    }
+    item->complete = last + 1 >= size;
+}
+
+QVariant AstTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+    return itemAt(index)->text;
+}
+
+QVariant AstTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return QString("AST树");
+    }
+    return QVariant();
+}
+
+// 未展开时判断能否展开，不创建子项
+bool AstTreeModel::mayHaveChildren(const Item &item) const
+{
+    switch (item.kind) {
+    case Item::Root:
+    case Item::Text:
+        return !item.children.empty();
+    case Item::Slot:
+    case Item::Call:
+        return true;
+    case Item::Statements:
+    case Item::Functions:
+    case Item::Params:
+    case Item::Arguments:
+        return listSize(item) > 0;
+    case Item::Node:
+        break;
+    }
+    const ASTNode *node = item.node;
+    if (auto program = dynamic_cast<const Program *>(node)) {
+        return !program->statements.empty() || !program->functions.empty();
+    }
+    if (auto block = dynamic_cast<const Block *>(node)) return !block->statements.empty();
+    if (auto primary = dynamic_cast<const PrimaryExpr *>(node)) return primary->kind() == PrimaryExpr::PAREN_EXPR;
+    return dynamic_cast<const FunctionDef *>(node) || dynamic_cast<const DeclareStmt *>(node) ||
+           dynamic_cast<const AssignStmt *>(node) || dynamic_cast<const IfStmt *>(node) ||
+           dynamic_cast<const ForStmt *>(node) || dynamic_cast<const WhileStmt *>(node) ||
+           dynamic_cast<const CompoundStmt *>(node) || dynamic_cast<const ReturnStmt *>(node) ||
+           dynamic_cast<const ExprStmt *>(node) || dynamic_cast<const BinaryExpr *>(node) ||
+           dynamic_cast<const UnaryExpr *>(node);
+}
+
+// 按列表分批创建子项的项返回列表长度，按字段生成子项的返回 -1
+int AstTreeModel::listSize(const Item &item) const
+{
+    switch (item.kind) {
+    case Item::Statements: return static_cast<int>(item.program->statements.size());
+    case Item::Functions: return static_cast<int>(item.program->functions.size());
+    case Item::Params: return static_cast<int>(item.function->params.size());
+    case Item::Arguments: return static_cast<int>(item.call->arguments.size());
+    case Item::Node:
+        if (auto block = dynamic_cast<const Block *>(item.node)) return static_cast<int>(block->statements.size());
+        return -1;
+    default:
+        return -1;
+    }
+}
+
+std::unique_ptr<AstTreeModel::Item> AstTreeModel::listChild(const Item &item, int index) const
+{
+    switch (item.kind) {
+    case Item::Statements: return nodeItem(item.program->statements[index].get());
+    case Item::Functions: return nodeItem(item.program->functions[index].get());
+    case Item::Params: {
+        const Param &param = item.function->params[index];
+        return std::make_unique<Item>(Item::Text, QString("%1 %2").arg(nameText(param.type)).arg(nameText(param.name)));
+    }
+    case Item::Arguments: return nodeItem(item.call->arguments[index]);
+    default:
+        return nodeItem(static_cast<const Block *>(item.node)->statements[index].get());
+    }
+}
+
+// 按字段生成 item 的子项，追加到 out（与原来逐项构建的树结构相同）
+void AstTreeModel::appendFields(const Item &item, Item &out) const
+{
+    // 有值时是标签项加子节点，没有值时是说明文字
+    auto field = [&out](const ASTNode *child, const char *label, const char *missing) {
+        if (child) {
+            auto slot = std::make_unique<Item>(Item::Slot, label);
+            slot->node = child;
+            out.append(std::move(slot));
+        } else {
+            out.append(std::make_unique<Item>(Item::Text, missing));
+        }
+    };
+
+    if (item.kind == Item::Slot) {
+        out.append(nodeItem(item.node));
+        return;
+    }
+    if (item.kind == Item::Call) {
+        out.append(std::make_unique<Item>(Item::Text, "Callee: " + nameText(item.call->callee)));
+        auto args = std::make_unique<Item>(Item::Arguments, "Arguments");
+        args->call = item.call;
+        out.append(std::move(args));
+        return;
+    }
+
+    const ASTNode *node = item.node;
+    if (auto program = dynamic_cast<const Program *>(node)) {
+        if (!program->statements.empty()) {
+            auto stmts = std::make_unique<Item>(Item::Statements, "Global Statements");
+            stmts->program = program;
+            out.append(std::move(stmts));
+        }
+        if (!program->functions.empty()) {
+            auto funcs = std::make_unique<Item>(Item::Functions, "Functions（函数）");
+            funcs->program = program;
+            out.append(std::move(funcs));
+        }
+    } else if (auto func = dynamic_cast<const FunctionDef *>(node)) {
+        if (!func->params.empty()) {
+            auto params = std::make_unique<Item>(Item::Params, "参数列表（" + QString::number(func->params.size()) + "个）");
+            params->function = func;
+            out.append(std::move(params));
+        }
+        field(func->body.get(), "函数体：", "函数体为空");
+    } else if (auto declare = dynamic_cast<const DeclareStmt *>(node)) {
+        field(declare->initValue.get(), "初始化值：", "无初始化值");
+    } else if (auto assign = dynamic_cast<const AssignStmt *>(node)) {
+        field(assign->value.get(), "赋值表达式：", "赋值表达式为空（无效）");
+    } else if (auto ifStmt = dynamic_cast<const IfStmt *>(node)) {
+        field(ifStmt->condition.get(), "条件表达式：", "条件表达式为空（无效）");
+        field(ifStmt->thenStmt.get(), "Then分支（条件为真时执行）：", "Then分支为空");
+        field(ifStmt->elseStmt.get(), "Else分支（条件为假时执行）：", "无Else分支");
+    } else if (auto forStmt = dynamic_cast<const ForStmt *>(node)) {
+        field(forStmt->init.get(), "初始化语句：", "无初始化语句");
+        field(forStmt->condition.get(), "循环条件：", "无条件循环");
+        field(forStmt->increment.get(), "增量表达式：", "无增量表达式");
+        field(forStmt->body.get(), "循环体：", "循环体为空");
+    } else if (auto whileStmt = dynamic_cast<const WhileStmt *>(node)) {
+        field(whileStmt->condition.get(), "循环条件：", "无条件循环");
+        field(whileStmt->body.get(), "循环体：", "循环体为空");
+    } else if (auto compound = dynamic_cast<const CompoundStmt *>(node)) {
+        if (compound->body) {
+            out.append(nodeItem(compound->body.get()));
+        } else {
+            out.append(std::make_unique<Item>(Item::Text, "复合语句体为空"));
+        }
+    } else if (auto returnStmt = dynamic_cast<const ReturnStmt *>(node)) {
+        field(returnStmt->returnValue.get(), "返回值：", "无返回值（如 return;）");
+    } else if (auto exprStmt = dynamic_cast<const ExprStmt *>(node)) {
+        if (exprStmt->expr) {
+            out.append(nodeItem(exprStmt->expr.get()));
+        } else {
+            out.append(std::make_unique<Item>(Item::Text, "表达式为空（无效）"));
+        }
+    } else if (auto binary = dynamic_cast<const BinaryExpr *>(node)) {
+        field(binary->left.get(), "左操作数：", "左操作数为空（无效）");
+        field(binary->right.get(), "右操作数：", "右操作数为空（无效）");
+    } else if (auto unary = dynamic_cast<const UnaryExpr *>(node)) {
+        field(unary->expr.get(), "操作数：", "操作数为空（无效）");
+    } else if (auto primary = dynamic_cast<const PrimaryExpr *>(node)) {
+        if (primary->kind() == PrimaryExpr::PAREN_EXPR) {
+            field(primary->parenExpr(), "括号内表达式：", "括号内无表达式（无效）");
+        }
+    }
+}
+
+// 函数调用和一元运算的基础表达式直接显示为调用/一元表达式本身
+std::unique_ptr<AstTreeModel::Item> AstTreeModel::nodeItem(const ASTNode *node) const
+{
+    if (auto primary = dynamic_cast<const PrimaryExpr *>(node)) {
+        if (primary->kind() == PrimaryExpr::CALL_EXPR) return callItem(primary->callExpr());
+        if (primary->kind() == PrimaryExpr::UNARY_EXPR) return nodeItem(primary->unaryExpr());
+    }
+    auto item = std::make_unique<Item>(Item::Node, nodeLabel(node));
+    item->node = node;
+    return item;
+}
+
+std::unique_ptr<AstTreeModel::Item> AstTreeModel::callItem(const CallExpr *call) const
+{
+    auto item = std::make_unique<Item>(Item::Call, "Call Expression");
+    item->call = call;
+    return item;
+}
+
+QString AstTreeModel::nodeLabel(const ASTNode *node) const
+{
+    if (dynamic_cast<const Program *>(node)) return "Program";
+    if (auto func = dynamic_cast<const FunctionDef *>(node)) {
+        return QString("Function: %1 (返回类型: %2)").arg(nameText(func->name)).arg(nameText(func->returnType));
+    }
+    if (auto block = dynamic_cast<const Block *>(node)) {
+        return "Block（代码块）" + QString::number(block->statements.size()) + "条语句";
+    }
+    if (auto declare = dynamic_cast<const DeclareStmt *>(node)) {
+        return QString("DeclareStmt: %1 %2").arg(nameText(declare->type)).arg(nameText(declare->varName));
+    }
+    if (auto assign = dynamic_cast<const AssignStmt *>(node)) {
+        return QString("AssignStmt: %1 = ...").arg(nameText(assign->varName));
+    }
+    if (dynamic_cast<const IfStmt *>(node)) return "IfStmt（条件语句）";
+    if (dynamic_cast<const ForStmt *>(node)) return "ForStmt（循环语句）";
+    if (dynamic_cast<const WhileStmt *>(node)) return "WhileStmt（循环语句）";
+    if (dynamic_cast<const CompoundStmt *>(node)) return "CompoundStmt（复合语句）";
+    if (dynamic_cast<const ReturnStmt *>(node)) return "ReturnStmt（返回语句）";
+    if (dynamic_cast<const ExprStmt *>(node)) return "ExprStmt（表达式语句）";
+    if (dynamic_cast<const BreakStmt *>(node)) return "BreakStmt（跳转语句）";
+    if (auto binary = dynamic_cast<const BinaryExpr *>(node)) {
+        return QString("BinaryExpr（运算符：%1）").arg(toQString(binary->op));
+    }
+    if (auto unary = dynamic_cast<const UnaryExpr *>(node)) {
+        return QString("UnaryExpr（运算符：%1%2）").arg(toQString(unary->op)).arg(unary->isPostfix ? "，后缀" : "");
+    }
+    if (auto primary = dynamic_cast<const PrimaryExpr *>(node)) {
+        switch (primary->kind()) {
+        case PrimaryExpr::NUMBER: return QString("Number: %1").arg(toQString(primary->numberValue()));
+        case PrimaryExpr::IDENTIFIER: return QString("Identifier: %1").arg(nameText(primary->identifier()));
+        case PrimaryExpr::STRING: return QString("String: \"%1\"").arg(toQString(primary->stringValue()));
+        case PrimaryExpr::PAREN_EXPR: return "ParenExpr（括号表达式）";
+        default: return "未知基础表达式类型";
+        }
+    }
+    if (dynamic_cast<const Stmt *>(node)) return "未知语句类型";
+    if (dynamic_cast<const Expr *>(node)) return "未知表达式类型";
+    return "未知节点类型";
+}
+
+// 名字/类型名在驻留表中的编号转换为显示文本
+QString AstTreeModel::nameText(int id) const
+{
+    return toQString(snapshot->program->names->str(id));
+}
@@ -0,0 +1,49 @@
+#ifndef ASTTREEMODEL_H
+#define ASTTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <memory>
+#include <vector>
+#include "compilesession.h"
+
+// AST 的树模型：直接包装快照中的 Program，子项在视图展开某一项时才创建（fetchMore），
+// 语句、函数、参数等长列表每次只创建一批。未展开的分支不占内存，打开很大的 AST 也不卡
+class AstTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    explicit AstTreeModel(QObject *parent = nullptr);
+    ~AstTreeModel() override;
+
+    void setSnapshot(std::shared_ptr<const CompileSnapshot> snapshot);
+    void clear();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Item;
+
+    Item *itemAt(const QModelIndex &index) const;
+    bool mayHaveChildren(const Item &item) const;
+    int listSize(const Item &item) const;
+    std::unique_ptr<Item> listChild(const Item &item, int index) const;
+    void appendFields(const Item &item, Item &out) const;
+    std::unique_ptr<Item> nodeItem(const ASTNode *node) const;
+    std::unique_ptr<Item> callItem(const CallExpr *call) const;
+    QString nodeLabel(const ASTNode *node) const;
+    QString nameText(int id) const;
+
+    std::shared_ptr<const CompileSnapshot> snapshot;
+    std::unique_ptr<Item> root;     // 不显示的根项
+};
+
+#endif // ASTTREEMODEL_H
@@ -1,78 +1,232 @@
 #include "CodeHighlighter.h"
-#include <QTextCharFormat>
-#include <QRegularExpression>
+#include <QElapsedTimer>
 #include <QFont>
-// 构造函数：初始化高亮规则
+#include <QFontMetrics>
+#include <QScrollBar>
+#include <QTextEdit>
+#include <QTextLayout>
+#include <algorithm>
+
+namespace {
+
+// 空闲处理每个时间片的上限（毫秒），期间不响应输入
+constexpr int IDLE_SLICE_MS = 10;
+
+// 待处理行的标记：挂在行上的用户数据不参与块状态比较，不会让 QSyntaxHighlighter 继续处理后面的行
+class PendingBlock : public QTextBlockUserData
+{
+};
+
+// 推迟处理的行中文字改过的行不扫描，行末状态记为未知；需要时由 incomingState() 补算
+constexpr int UnknownState = -2;
+
+} // namespace
+
+// 构造函数：初始化高亮格式
 CodeHighlighter::CodeHighlighter(QTextDocument *parent)
-    : QSyntaxHighlighter(parent)
+    : QSyntaxHighlighter(static_cast<QObject *>(parent))
 {
     // 关键字高亮格式
     keywordFormat.setForeground(Qt::blue);
     keywordFormat.setFontWeight(QFont::Bold);
 
-    // 关键字列表
-    QStringList keywordPatterns = {
-        "\\bint\\b", "\\bchar\\b", "\\bvoid\\b", "\\breturn\\b",
-        "\\bif\\b", "\\belse\\b", "\\bfor\\b", "\\bwhile\\b", "\\bprintf\\b", "\\bscanf\\b"
-    };
-
-    // 添加关键字高亮规则
-    for (const QString &pattern : keywordPatterns) {
-        highlightingRules.append({
-            QRegularExpression(pattern),
-            keywordFormat
-        });
-    }
-
     // 数字高亮格式
-    QTextCharFormat numberFormat;
     numberFormat.setForeground(Qt::darkGreen);
-    highlightingRules.append({
-        QRegularExpression("\\b\\d+\\b"),
-        numberFormat
-    });
 
-    // 字符串高亮格式（修复引号匹配问题）
-    QTextCharFormat quotationFormat;
+    // 字符串高亮格式
     quotationFormat.setForeground(Qt::darkMagenta);
-    highlightingRules.append({
-        QRegularExpression("\\\"[^\\\"]*\\\""),  // 正确匹配双引号字符串
-        quotationFormat
-    });
 
+    // 注释高亮格式（单行和多行）
+    commentFormat.setForeground(Qt::gray);
 
-    // 单行注释高亮格式
-    singleLineCommentFormat.setForeground(Qt::gray);
-    highlightingRules.append({
-        QRegularExpression("//[^\\n]*"),
-        singleLineCommentFormat
-    });
-
-    // 函数名高亮格式
+    // 函数名高亮格式：标识符后（隔着空白或注释）紧跟'('
     functionFormat.setFontItalic(true);
     functionFormat.setForeground(Qt::darkCyan);
-    highlightingRules.append({
-        QRegularExpression("\\b[A-Za-z0-9_]+(?=\\s*\\()"),
-        functionFormat
+
+    // 零间隔定时器在事件队列空闲时触发，每次处理一个时间片
+    idleTimer.setSingleShot(true);
+    idleTimer.setInterval(0);
+    connect(&idleTimer, &QTimer::timeout, this, &CodeHighlighter::highlightPending);
+    if (parent) {
+        // 先于 QSyntaxHighlighter 连接 contentsChange，使 documentChanged() 在本次高亮之前执行
+        connect(parent, &QTextDocument::contentsChange, this, &CodeHighlighter::documentChanged);
+        setDocument(parent);
+    }
+}
+
+void CodeHighlighter::setEditor(QTextEdit *textEdit)
+{
+    editor = textEdit;
+    updateViewport();
+    // 滚动后先补上新露出的待处理行
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, [this] {
+        updateViewport();
+        if (pendingFrom >= 0) idleTimer.start();
     });
 }
 
-// 重写高亮处理函数
+bool CodeHighlighter::largeDocument() const
+{
+    return largeThreshold > 0 && document()->blockCount() > largeThreshold;
+}
+
+// 在 QSyntaxHighlighter 处理本次修改之前记下修改的范围和光标所在行
+void CodeHighlighter::documentChanged(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+    if (rehighlighting) return;     // 空闲补高亮改变格式时也会发出该信号
+    changeStart = position;
+    changeEnd = position + charsAdded;
+    // 编辑位置之后的行号会移动，待处理的起点退到编辑处，避免漏掉移上来的待处理行
+    if (pendingFrom >= 0) {
+        pendingFrom = std::min(pendingFrom, document()->findBlock(position).blockNumber());
+    }
+    // 编辑后视图滚动到光标处（粘贴后光标在插入文本的末尾），光标所在的一屏与当前可见的行一样立即高亮。
+    // 此时文档布局尚未更新，不能按坐标查询第一个可见的行，沿用滚动时取得的值
+    if (editor) {
+        visibleLines = linesPerScreen();
+        cursorBlock = editor->textCursor().blockNumber();
+    }
+}
+
+// QSyntaxHighlighter 对修改过的行逐行调用，行末状态改变时继续处理下一行。
+// 大文档模式下不可见的行推迟处理
 void CodeHighlighter::highlightBlock(const QString &text)
 {
-    // 应用所有高亮规则
-    for (const HighlightingRule &rule : qAsConst(highlightingRules)) {
-        QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-        while (matchIterator.hasNext()) {
-            QRegularExpressionMatch match = matchIterator.next();
-            setFormat(
-                match.capturedStart(),
-                match.capturedLength(),
-                rule.format
-            );
+    QTextBlock block = currentBlock();
+    if (block != forcedBlock && largeDocument()) {
+        int number = block.blockNumber();
+        if (!isVisible(number)) {
+            deferBlock(block, number);
+            return;
         }
     }
+    setCurrentBlockUserData(nullptr);
+    highlightLine(block, text);
+}
 
-    // 设置多行注释的高亮（如果需要）
-    setCurrentBlockState(0);
+// 推迟格式化，记为待处理，每行只花常数时间（粘贴大段文本时 QSyntaxHighlighter 对插入的每一行都会调用）。
+// 文字改过的行原来的格式已对不上，不设置即被清除，行末状态记为未知，不扫描文字；
+// 文字没改的行保留原来的格式（不设置时会被清除）和状态，状态不变，QSyntaxHighlighter 的这一串处理就在此停下
+void CodeHighlighter::deferBlock(const QTextBlock &block, int number)
+{
+    if (block.position() <= changeEnd && block.position() + block.length() > changeStart) {
+        setCurrentBlockState(UnknownState);
+    } else {
+        const auto ranges = block.layout()->formats();
+        for (const QTextLayout::FormatRange &range : ranges) {
+            setFormat(range.start, range.length, range.format);
+        }
+    }
+    if (!block.userData()) setCurrentBlockUserData(new PendingBlock);
+    if (pendingFrom < 0 || number < pendingFrom) pendingFrom = number;
+    if (!idleTimer.isActive()) idleTimer.start();
+}
+
+bool CodeHighlighter::isVisible(int number) const
+{
+    if (number >= visibleFirst && number <= visibleFirst + visibleLines) return true;
+    return cursorBlock >= 0 && number >= cursorBlock - visibleLines && number <= cursorBlock + visibleLines;
+}
+
+// 编辑器一屏能显示的行数；折行时一屏实际的行更少，多算几行无妨
+int CodeHighlighter::linesPerScreen() const
+{
+    return editor->viewport()->height() / std::max(1, editor->fontMetrics().lineSpacing()) + 1;
+}
+
+// 按当前布局取编辑器显示的第一行，以及一屏的行数和光标所在行
+void CodeHighlighter::updateViewport()
+{
+    if (!editor) {
+        visibleFirst = 0;
+        visibleLines = -1;
+        cursorBlock = -1;
+        return;
+    }
+    visibleFirst = editor->cursorForPosition(QPoint(0, 0)).blockNumber();
+    visibleLines = linesPerScreen();
+    cursorBlock = editor->textCursor().blockNumber();
+}
+
+void CodeHighlighter::rehighlightPendingBlock(const QTextBlock &block)
+{
+    rehighlighting = true;
+    rehighlightBlock(block);
+    rehighlighting = false;
+}
+
+// 空闲时补高亮待处理的行：先处理可见的行，再从 pendingFrom 往后，用完一个时间片就让出事件循环。
+// 补上的行状态改变时，QSyntaxHighlighter 把下一行也推迟为待处理，随后在本循环中接着处理
+void CodeHighlighter::highlightPending()
+{
+    if (pendingFrom < 0) return;
+    updateViewport();
+    QTextDocument *doc = document();
+    auto highlightRange = [this, doc](int first, int last) {
+        for (QTextBlock block = doc->findBlockByNumber(std::max(first, 0));
+             block.isValid() && block.blockNumber() <= last; block = block.next()) {
+            if (block.userData()) rehighlightPendingBlock(block);
+        }
+    };
+    highlightRange(visibleFirst, visibleFirst + visibleLines);
+    if (cursorBlock >= 0) highlightRange(cursorBlock - visibleLines, cursorBlock + visibleLines);
+
+    QElapsedTimer clock;
+    clock.start();
+    QTextBlock block = doc->findBlockByNumber(pendingFrom);
+    while (block.isValid() && clock.elapsed() < IDLE_SLICE_MS) {
+        if (block.userData()) {
+            forcedBlock = block;
+            rehighlightPendingBlock(block);
+        }
+        block = block.next();
+    }
+    forcedBlock = QTextBlock();
+    if (block.isValid()) {
+        pendingFrom = block.blockNumber();
+        idleTimer.start();
+    } else {
+        pendingFrom = -1;
+    }
+}
+
+// 上一行的行末状态。上一行推迟处理、状态未知时，向前找到状态已知的行，再逐行只计算行末状态
+// （highlightscan::endState()，不设置格式）；算出的状态写回这些行，它们仍待处理，之后不必再算
+int CodeHighlighter::incomingState(const QTextBlock &block)
+{
+    QTextBlock previous = block.previous();
+    if (!previous.isValid() || previous.userState() != UnknownState) return previousBlockState();
+    QTextBlock known = previous;
+    while (known.isValid() && known.userState() == UnknownState) known = known.previous();
+    int state = known.isValid() ? known.userState() : -1;
+    for (QTextBlock line = known.isValid() ? known.next() : document()->begin(); line != block; line = line.next()) {
+        const QString text = line.text();
+        state = highlightscan::endState(reinterpret_cast<const char16_t *>(text.constData()), text.size(), state);
+        line.setUserState(state);
+    }
+    return state;
+}
+
+const QTextCharFormat &CodeHighlighter::formatFor(highlightscan::Kind kind) const
+{
+    switch (kind) {
+    case highlightscan::Kind::Keyword: return keywordFormat;
+    case highlightscan::Kind::Number: return numberFormat;
+    case highlightscan::Kind::String: return quotationFormat;
+    case highlightscan::Kind::Comment: return commentFormat;
+    case highlightscan::Kind::Function: return functionFormat;
+    }
+    return keywordFormat;
+}
+
+// 按 Lexer 的规则扫描一遍本行（见 highlightscan.h），接着上一行的行末状态
+void CodeHighlighter::highlightLine(const QTextBlock &block, const QString &text)
+{
+    const auto *s = reinterpret_cast<const char16_t *>(text.constData());
+    int state = highlightscan::scanLine(s, text.size(), incomingState(block),
+                                        [this](int start, int count, highlightscan::Kind kind) {
+                                            setFormat(start, count, formatFor(kind));
+                                        });
+    setCurrentBlockState(state);
 }
@@ -3,32 +3,65 @@
 
 #include <QSyntaxHighlighter>
 #include <QTextDocument>
-#include <QRegularExpression>
+#include <QTextCharFormat>
+#include <QTextBlock>
+#include <QTimer>
+#include "highlightscan.h"
 
+class QTextEdit;
+
+// 按 Lexer 的规则逐字符扫描一遍每行文本（highlightscan.h）：关键字表、数字、字符串和注释的判定与编译器一致。
+// 块注释和字符串可以跨行，行末仍在其中时记入块状态，下一行从该状态继续。
+// 文档行数超过阈值时进入大文档模式：只立即高亮编辑器中可见的行和光标所在的一屏，其余的行记为待处理，
+// 之后在空闲时按时间片从前往后补上
 class CodeHighlighter : public QSyntaxHighlighter
 {
     Q_OBJECT
 
 public:
+    static constexpr int DEFAULT_LARGE_DOCUMENT_THRESHOLD = 10000;
+
     CodeHighlighter(QTextDocument *parent = nullptr);
 
+    // 大文档模式下优先高亮该编辑器中可见的行；不设置时从文档开头依次高亮
+    void setEditor(QTextEdit *editor);
+    // 行数超过 blocks 时自动切换到大文档模式；0 表示始终立即高亮全部修改的行
+    void setLargeDocumentThreshold(int blocks) { largeThreshold = blocks; }
+    int largeDocumentThreshold() const { return largeThreshold; }
+
 protected:
     void highlightBlock(const QString &text) override;
 
 private:
-    struct HighlightingRule
-    {
-        QRegularExpression pattern;
-        QTextCharFormat format;
-    };
-    QVector<HighlightingRule> highlightingRules;
+    void highlightLine(const QTextBlock &block, const QString &text);
+    int incomingState(const QTextBlock &block);
+    const QTextCharFormat &formatFor(highlightscan::Kind kind) const;
+    bool largeDocument() const;
+    void documentChanged(int position, int charsRemoved, int charsAdded);
+    void deferBlock(const QTextBlock &block, int number);
+    bool isVisible(int number) const;
+    int linesPerScreen() const;
+    void updateViewport();
+    void rehighlightPendingBlock(const QTextBlock &block);
+    void highlightPending();
 
     QTextCharFormat keywordFormat;
-    QTextCharFormat classFormat;
-    QTextCharFormat singleLineCommentFormat;
-    QTextCharFormat multiLineCommentFormat;
+    QTextCharFormat numberFormat;
+    QTextCharFormat commentFormat;
     QTextCharFormat quotationFormat;
     QTextCharFormat functionFormat;
+
+    int largeThreshold = DEFAULT_LARGE_DOCUMENT_THRESHOLD;
+    QTextEdit *editor = nullptr;
+    int visibleFirst = 0;       // 编辑器中第一个可见的行（滚动时更新）
+    int visibleLines = -1;      // 一屏的行数；没有编辑器时为 -1
+    int cursorBlock = -1;       // 光标所在行
+    int changeStart = 0;        // 最近一次修改后文字改变的范围 [changeStart, changeEnd]
+    int changeEnd = -1;
+    int pendingFrom = -1;       // 最靠前的待处理行，之前的行都已高亮；-1 表示没有待处理的行
+    QTextBlock forcedBlock;     // 空闲处理中正在补高亮的行
+    bool rehighlighting = false;    // 正在空闲补高亮
+    QTimer idleTimer;
 };
 
 #endif // CODEHIGHLIGHTER_H
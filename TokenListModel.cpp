@@ -0,0 +1,89 @@
+#include "TokenListModel.h"
+#include <QBrush>
+
+TokenListModel::TokenListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void TokenListModel::setSnapshot(std::shared_ptr<const CompileSnapshot> newSnapshot)
+{
+    beginResetModel();
+    snapshot = std::move(newSnapshot);
+    rebuildRows();
+    endResetModel();
+}
+
+void TokenListModel::clear()
+{
+    setSnapshot(nullptr);
+}
+
+void TokenListModel::setTypeFilter(int type)
+{
+    if (type == typeFilter) return;
+    beginResetModel();
+    typeFilter = type;
+    rebuildRows();
+    endResetModel();
+}
+
+void TokenListModel::rebuildRows()
+{
+    rows.clear();
+    if (!snapshot || typeFilter < 0) return;
+    const std::vector<Token> &tokens = snapshot->tokens;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (static_cast<int>(tokens[i].type) == typeFilter) {
+            rows.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+int TokenListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid() || !snapshot) return 0;
+    return typeFilter < 0 ? static_cast<int>(snapshot->tokens.size()) : static_cast<int>(rows.size());
+}
+
+QString TokenListModel::typeName(TokenType type)
+{
+    switch (type) {
+    case TokenType::KEYWORD: return "关键字";
+    case TokenType::IDENTIFIER: return "标识符";
+    case TokenType::NUMBER: return "数字";
+    case TokenType::OPERATOR: return "运算符";
+    case TokenType::PUNCTUATOR: return "标点";
+    case TokenType::STRING: return "字符串";
+    case TokenType::ERROR_TOKEN: return "词法错误";
+    case TokenType::EOF_TOKEN: return "文件结束";
+    }
+    return QString();
+}
+
+QVariant TokenListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+    int i = tokenIndex(index.row());
+    const Token &token = snapshot->tokens[i];
+
+    if (role == Qt::DisplayRole) {
+        SourceLocation loc = snapshot->locations[i];
+        return QString("%1 [%2] (行:%3, 列:%4)")
+            .arg(QString::fromUtf8(token.value.data(), static_cast<int>(token.value.size())))
+            .arg(typeName(token.type))
+            .arg(loc.line)
+            .arg(loc.column);
+    }
+    // 根据Token类型设置不同颜色
+    if (role == Qt::ForegroundRole) {
+        switch (token.type) {
+        case TokenType::KEYWORD: return QBrush(Qt::blue);
+        case TokenType::NUMBER: return QBrush(Qt::darkGreen);
+        case TokenType::STRING: return QBrush(Qt::darkMagenta);
+        case TokenType::OPERATOR: return QBrush(Qt::darkRed);
+        default: break;
+        }
+    }
+    return QVariant();
+}
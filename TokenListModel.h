@@ -0,0 +1,37 @@
+#ifndef TOKENLISTMODEL_H
+#define TOKENLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <memory>
+#include <vector>
+#include "compilesession.h"
+
+// Token 列表的模型：直接读取编译快照中的 Token 数组，视图请求哪一行才格式化哪一行，
+// 显示代价只与可见行数有关。按类型过滤时只保存匹配的下标，不复制 Token
+class TokenListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit TokenListModel(QObject *parent = nullptr);
+
+    void setSnapshot(std::shared_ptr<const CompileSnapshot> snapshot);
+    void clear();
+    // 只显示 type 类型的 Token；type 为 -1 时显示全部
+    void setTypeFilter(int type);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    static QString typeName(TokenType type);
+
+private:
+    void rebuildRows();
+    int tokenIndex(int row) const { return typeFilter < 0 ? row : rows[row]; }
+
+    std::shared_ptr<const CompileSnapshot> snapshot;
+    int typeFilter = -1;
+    std::vector<int> rows;  // 过滤时各行对应的 Token 下标
+};
+
+#endif // TOKENLISTMODEL_H
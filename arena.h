@@ -0,0 +1,169 @@
+// arena.h
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class Arena;
+
+// 指向竞技场中对象的指针：可像 std::unique_ptr 一样使用（get/->/release、可转换为基类指针），
+// 但不负责释放，本身平凡析构，因此只含 ArenaPtr 的节点也是平凡析构的
+template <typename T>
+class ArenaPtr {
+public:
+    ArenaPtr() = default;
+    ArenaPtr(std::nullptr_t) {}
+    explicit ArenaPtr(T* p) : ptr(p) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    ArenaPtr(const ArenaPtr<U>& other) : ptr(other.get()) {}
+
+    T* get() const { return ptr; }
+    T* operator->() const { return ptr; }
+    T& operator*() const { return *ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+    T* release() {
+        T* p = ptr;
+        ptr = nullptr;
+        return p;
+    }
+
+private:
+    T* ptr = nullptr;
+};
+
+// 竞技场（bump）分配器：按块向前分配，不支持单独释放，Arena 析构时整体释放。
+// 平凡析构的类型不做任何记录；其它类型登记析构函数，Arena 析构时按创建的逆序调用
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    ~Arena() {
+        for (Finalizer* f = finalizers; f; f = f->next) {
+            f->destroy(f->object);
+        }
+    }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // 分配 size 字节、按 align 对齐的未初始化内存
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (blocks.empty() || offset + size > capacity) {
+            newBlock(size + align);
+            offset = (used + align - 1) & ~(align - 1);
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+
+    // 在竞技场中构造对象
+    template <typename T, typename... Args>
+    ArenaPtr<T> make(Args&&... args) {
+        void* memory = allocate(sizeof(T), alignof(T));
+        T* object = new (memory) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            auto* f = new (allocate(sizeof(Finalizer), alignof(Finalizer))) Finalizer;
+            f->destroy = [](void* p) { static_cast<T*>(p)->~T(); };
+            f->object = object;
+            f->next = finalizers;
+            finalizers = f;
+        }
+        return ArenaPtr<T>(object);
+    }
+
+    // 把文本复制到竞技场中，返回的视图与 Arena 同生命周期
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) return std::string_view();
+        char* memory = static_cast<char*>(allocate(text.size(), 1));
+        std::memcpy(memory, text.data(), text.size());
+        return std::string_view(memory, text.size());
+    }
+
+    // 接管另一个竞技场的全部内存块和待析构对象，其中的对象随本竞技场一起释放；other 变为空。
+    // 并行解析时各线程在自己的竞技场中分配节点，结束后并入 Program 的竞技场
+    void adopt(Arena& other) {
+        if (other.blocks.empty()) return;
+        // 接管的块放在前面，本竞技场继续在原来的当前块（blocks.back()）中分配
+        blocks.insert(blocks.begin(), std::make_move_iterator(other.blocks.begin()),
+                      std::make_move_iterator(other.blocks.end()));
+        reserved += other.reserved;
+        if (other.finalizers) {
+            Finalizer* last = other.finalizers;
+            while (last->next) last = last->next;
+            last->next = finalizers;
+            finalizers = other.finalizers;
+        }
+        other.blocks.clear();
+        other.capacity = other.used = other.reserved = 0;
+        other.finalizers = nullptr;
+    }
+
+    // 已向系统申请的总字节数
+    size_t reservedBytes() const { return reserved; }
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+
+    void newBlock(size_t minSize) {
+        // 块大小逐次翻倍直到 1MB，小程序只申请一两块，大程序每 1MB 才申请一次
+        if (blockSize < 1024 * 1024 && !blocks.empty()) blockSize *= 2;
+        capacity = minSize > blockSize ? minSize : blockSize;
+        blocks.emplace_back(new char[capacity]);
+        reserved += capacity;
+        used = 0;
+    }
+
+    size_t blockSize;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t capacity = 0;    // 当前块大小
+    size_t used = 0;        // 当前块已用字节
+    size_t reserved = 0;
+    Finalizer* finalizers = nullptr;
+};
+
+// 元素存放在竞技场中的动态数组，只支持尾部追加；扩容时旧空间留在竞技场中不回收。
+// 元素须为平凡析构类型（如 ArenaPtr、string_view），数组本身也不需要析构
+template <typename T>
+class ArenaList {
+    static_assert(std::is_trivially_destructible_v<T>, "ArenaList 只能存放平凡析构的元素");
+public:
+    void push_back(Arena& arena, const T& value) {
+        if (count == capacity) grow(arena);
+        new (items + count) T(value);
+        ++count;
+    }
+
+    T* begin() const { return items; }
+    T* end() const { return items + count; }
+    T& operator[](size_t i) const { return items[i]; }
+    T& back() const { return items[count - 1]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    void grow(Arena& arena) {
+        size_t newCapacity = capacity ? capacity * 2 : 4;
+        T* newItems = static_cast<T*>(arena.allocate(sizeof(T) * newCapacity, alignof(T)));
+        for (size_t i = 0; i < count; ++i) new (newItems + i) T(items[i]);
+        items = newItems;
+        capacity = newCapacity;
+    }
+
+    T* items = nullptr;
+    size_t count = 0;
+    size_t capacity = 0;
+};
+
+#endif // ARENA_H
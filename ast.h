@@ -4,7 +4,10 @@
 
 #include <vector>
 #include <memory>
-#include <string>
+#include <string_view>
+#include <type_traits>
+#include "arena.h"
+#include "interner.h"
 class Program;
 class FunctionDef;
 class Param;
@@ -45,11 +48,15 @@ public:
     virtual void visit(UnaryExpr& node) = 0;
 };
 // AST节点基类（所有节点的共同接口）
+// 节点都分配在 Arena 中，由 Arena 整体释放，不会通过基类指针 delete，因此析构函数不必是虚函数。
+// 除 Program 外，节点只含 ArenaPtr、ArenaList、string_view（文本复制在 Arena 中）和整数
+// （名字、类型名均为驻留表编号，文本见 Program::names），都是平凡析构的，
+// 释放整棵树只需归还 Arena 的内存块
 class ASTNode {
 public:
-    virtual ~ASTNode() = default;  // 虚析构函数，确保子类正确析构
-    std::string returnType;
     virtual void accept(ASTVisitor& visitor) = 0;
+protected:
+    ~ASTNode() = default;
 };
 
 // 语句基类（所有语句的父类）
@@ -61,32 +68,34 @@ public:
 // 程序节点（整个程序）
 class Program : public ASTNode {
 public:
-    std::vector<std::unique_ptr<Stmt>> statements;
-    std::vector<std::unique_ptr<class FunctionDef>> functions;  // 函数列表
+    std::shared_ptr<Arena> arena;   // 所有子节点所在的竞技场（须最先声明、最后析构）
+    std::shared_ptr<const StringInterner> names;    // 标识符编号对应的名字
+    std::vector<ArenaPtr<Stmt>> statements;
+    std::vector<ArenaPtr<class FunctionDef>> functions;  // 函数列表
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
-// 函数定义节点
-class FunctionDef : public ASTNode {
+// 参数节点（函数参数）
+class Param {
 public:
-    std::string returnType;  // 返回类型（如"int"）
-    std::string name;        // 函数名（如"main"）
-    std::vector<class Param> params;  // 参数列表
-    std::unique_ptr<class Block> body;  // 函数体（代码块）
-    void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
+    int type;  // 参数类型（如"int"）
+    int name;  // 参数名（如"a"）
 };
 
-// 参数节点（函数参数）
-class Param {
+// 函数定义节点
+class FunctionDef : public ASTNode {
 public:
-    std::string type;  // 参数类型（如"int"）
-    std::string name;  // 参数名（如"a"）
+    int returnType;  // 返回类型（如"int"）
+    int name;        // 函数名（如"main"）
+    ArenaList<class Param> params;  // 参数列表
+    ArenaPtr<class Block> body;  // 函数体（代码块）
+    void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // 代码块节点（{}包裹的语句）
 class Block : public ASTNode {
 public:
-    std::vector<std::unique_ptr<class Stmt>> statements;  // 语句列表
+    ArenaList<ArenaPtr<class Stmt>> statements;  // 语句列表
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -95,29 +104,29 @@ public:
 // 声明语句节点（如int a = 10;）
 class DeclareStmt : public Stmt {
 public:
-    std::string type;  // 类型（如"int"）
-    std::string varName;  // 变量名（如"a"）
-    std::unique_ptr<class Expr> initValue;  // 初始化值（可选，如10）
+    int type;  // 类型（如"int"）
+    int varName;  // 变量名（如"a"）
+    ArenaPtr<class Expr> initValue;  // 初始化值（可选，如10）
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // 赋值语句节点（如a = 20;）
 class AssignStmt : public Stmt {
 public:
-    std::string varName;  // 变量名（如"a"）
-    std::unique_ptr<Expr> value;  // 赋值表达式（如20）
-    std::string varType;    // 变量类型（从符号表获取）
-    std::string exprType;   // 表达式类型（推导得出）
+    int varName;  // 变量名（如"a"）
+    ArenaPtr<Expr> value;  // 赋值表达式（如20）
+    int varType;    // 变量类型（从符号表获取）
+    int exprType;   // 表达式类型（推导得出）
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // 复合语句节点（用于包装代码块）
 class CompoundStmt : public Stmt {
 public:
-    std::unique_ptr<Block> body;  // 存储代码块
+    ArenaPtr<Block> body;  // 存储代码块
 
     // 构造函数
-    explicit CompoundStmt(std::unique_ptr<Block> block)
+    explicit CompoundStmt(ArenaPtr<Block> block)
         : body(std::move(block)) {}
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
@@ -125,22 +134,22 @@ public:
 // if语句节点
 class IfStmt : public Stmt {
 public:
-    std::unique_ptr<Expr> condition;  // 条件表达式（如a > 5）
-    std::unique_ptr<Stmt> thenStmt;   // if分支语句
-    std::unique_ptr<Stmt> elseStmt;   // else分支语句（可选）
+    ArenaPtr<Expr> condition;  // 条件表达式（如a > 5）
+    ArenaPtr<Stmt> thenStmt;   // if分支语句
+    ArenaPtr<Stmt> elseStmt;   // else分支语句（可选）
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 // while语句节点（继承自Stmt，与IfStmt同级）
 class WhileStmt : public Stmt {
 public:
-    std::unique_ptr<Expr> condition;  // 循环条件（如i < 10）
-    std::unique_ptr<Stmt> body;       // 循环体（如代码块或单条语句）
+    ArenaPtr<Expr> condition;  // 循环条件（如i < 10）
+    ArenaPtr<Stmt> body;       // 循环体（如代码块或单条语句）
     int line;  // 位置信息（行号，用于错误提示）
     int column;
 
     // 构造函数（初始化位置信息）
-    WhileStmt(std::unique_ptr<Expr> cond, std::unique_ptr<Stmt> b, int l, int c)
+    WhileStmt(ArenaPtr<Expr> cond, ArenaPtr<Stmt> b, int l, int c)
         : condition(std::move(cond)), body(std::move(b)), line(l), column(c) {}
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
@@ -149,16 +158,16 @@ public:
 // for语句节点（继承自Stmt）
 class ForStmt : public Stmt {
 public:
-    std::unique_ptr<Stmt> init;       // 初始化语句（如int i=0）
-    std::unique_ptr<Expr> condition;  // 循环条件（如i < 10）
-    std::unique_ptr<Expr> increment;  // 增量表达式（如i++）
-    std::unique_ptr<Stmt> body;       // 循环体
+    ArenaPtr<Stmt> init;       // 初始化语句（如int i=0）
+    ArenaPtr<Expr> condition;  // 循环条件（如i < 10）
+    ArenaPtr<Expr> increment;  // 增量表达式（如i++）
+    ArenaPtr<Stmt> body;       // 循环体
     int line;
     int column;
 
     // 构造函数
-    ForStmt(std::unique_ptr<Stmt> i, std::unique_ptr<Expr> cond,
-            std::unique_ptr<Expr> inc, std::unique_ptr<Stmt> b, int l, int c)
+    ForStmt(ArenaPtr<Stmt> i, ArenaPtr<Expr> cond,
+            ArenaPtr<Expr> inc, ArenaPtr<Stmt> b, int l, int c)
         : init(std::move(i)), condition(std::move(cond)),
         increment(std::move(inc)), body(std::move(b)), line(l), column(c) {}
 
@@ -167,7 +176,7 @@ public:
 // return语句节点
 class ReturnStmt : public Stmt {
 public:
-    std::unique_ptr<Expr> returnValue;  // 返回值（可选，如0）
+    ArenaPtr<Expr> returnValue;  // 返回值（可选，如0）
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -179,7 +188,7 @@ public:
 // 表达式语句节点（如printf("hello");）
 class ExprStmt : public Stmt {
 public:
-    std::unique_ptr<Expr> expr;  // 表达式
+    ArenaPtr<Expr> expr;  // 表达式
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
@@ -191,23 +200,25 @@ class Expr : public ASTNode {
 // 二元表达式节点（如a + b）
 class BinaryExpr : public Expr {
 public:
-    std::string op;  // 运算符（如"+"、"*"、">"）
-    std::unique_ptr<Expr> left;  // 左操作数
-    std::unique_ptr<Expr> right; // 右操作数
+    std::string_view op;  // 运算符（如"+"、"*"、">"）
+    ArenaPtr<Expr> left;  // 左操作数
+    ArenaPtr<Expr> right; // 右操作数
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
 };
 
 struct CallExpr {
-    std::string callee;               // 被调用函数名
-    std::vector<Expr*> arguments;          // 参数表达式列表
-    int line;                         // 行号信息
+    int callee;                       // 被调用函数名
+    ArenaList<Expr*> arguments;       // 参数表达式列表
+    int line;                         // 行号信息（函数名所在位置）
     int column;                       // 列号信息
+    int offset;                       // 函数名在源码中的字节偏移和长度
+    int length;
 };
 
 class UnaryExpr : public Expr {
 public:
-    std::string op;                  // 运算符（如"++"、"--"、"!"）
-    std::unique_ptr<Expr> expr;      // 操作数表达式
+    std::string_view op;             // 运算符（如"++"、"--"、"!"）
+    ArenaPtr<Expr> expr;             // 操作数表达式
     bool isPostfix;                  // true表示后缀运算符（如i++），false表示前缀（如++i）
 
     void accept(ASTVisitor& visitor) override {
@@ -216,20 +227,47 @@ public:
 };
 
 // 基础表达式节点（数字、标识符、字符串、括号表达式）
+// 各种类型只用到其中一个字段，因此共用一块存储（带标签的联合体），由 kind() 区分；
+// 通过 set*() 写入，读取时只能调用与 kind() 相符的访问函数
 class PrimaryExpr : public Expr {
 public:
     enum Type { NUMBER, IDENTIFIER, STRING, PAREN_EXPR ,CALL_EXPR,UNARY_EXPR };
-    Type type;  // 基础表达式类型
+    Type kind() const { return type; }  // 基础表达式类型
 
-    // 根据类型存储对应值
-    std::string numberValue;    // 数字值（如"123"）
-    std::string identifier;     // 标识符（如"a"、"printf"）
-    std::string stringValue;    // 字符串值（如"hello"）
-    std::unique_ptr<Expr> parenExpr;  // 括号表达式（如(a + b)）
-    std::unique_ptr<CallExpr> callExpr;//函数调用
-    std::unique_ptr<UnaryExpr> unaryExpr;//一元
+    std::string_view numberValue() const { return {text.data, text.size}; }  // 数字值（如"123"）
+    int identifier() const { return nameId; }               // 标识符在驻留表中的编号（名字见 Program::names）
+    std::string_view stringValue() const { return {text.data, text.size}; }  // 字符串值（如"hello"）
+    Expr* parenExpr() const { return paren; }               // 括号表达式（如(a + b)）
+    CallExpr* callExpr() const { return call; }             // 函数调用
+    UnaryExpr* unaryExpr() const { return unary; }          // 一元
+
+    void setNumber(std::string_view value) { type = NUMBER; text = {value.data(), value.size()}; }
+    void setIdentifier(int id) { type = IDENTIFIER; nameId = id; }
+    void setString(std::string_view value) { type = STRING; text = {value.data(), value.size()}; }
+    void setParen(Expr* expr) { type = PAREN_EXPR; paren = expr; }
+    void setCall(CallExpr* expr) { type = CALL_EXPR; call = expr; }
+    void setUnary(UnaryExpr* expr) { type = UNARY_EXPR; unary = expr; }
 
     void accept(ASTVisitor& visitor) override { visitor.visit(*this); }
+
+private:
+    struct Text {                   // 与 string_view 相同，但可平凡构造，能放进联合体
+        const char* data;
+        size_t size;
+    };
+    Type type = NUMBER;
+    union {
+        Text text;                  // NUMBER / STRING（文本在 Arena 中）
+        int nameId;                 // IDENTIFIER
+        Expr* paren = nullptr;      // PAREN_EXPR
+        CallExpr* call;             // CALL_EXPR
+        UnaryExpr* unary;           // UNARY_EXPR
+    };
 };
 
+static_assert(std::is_trivially_destructible_v<Block> && std::is_trivially_destructible_v<FunctionDef> &&
+              std::is_trivially_destructible_v<DeclareStmt> && std::is_trivially_destructible_v<AssignStmt> &&
+              std::is_trivially_destructible_v<BinaryExpr> && std::is_trivially_destructible_v<PrimaryExpr>,
+              "AST节点须为平凡析构，才能由 Arena 整体释放而不逐个调用析构函数");
+
 #endif // AST_H
@@ -0,0 +1,66 @@
+// ast_memory_bench.cpp
+// AST 内存占用报告：生成含约 N 个基础表达式的源码并解析，输出各节点类型的 sizeof、
+// Arena 申请的字节数以及解析前后常驻内存（RSS，仅 Linux）的增量。
+// 用法: ast_memory_bench [基础表达式个数，默认 1000000]
+#include "lexer.h"
+#include "parser.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+// 每条赋值语句 x = a + K * (b - M); 含 a、K、括号、b、M 共 5 个基础表达式
+std::string makeSource(long primaryCount) {
+    std::string source = "int main(int a, int b) {\n    int x = 0;\n";
+    for (long i = 0; i < primaryCount / 5; ++i) {
+        source += "    x = a + " + std::to_string(i % 97) + " * (b - " + std::to_string(i % 13) + ");\n";
+    }
+    source += "    return x;\n}\n";
+    return source;
+}
+
+// 当前常驻内存（KB），无法获取时返回 -1
+long residentKb() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    if (!(statm >> size >> resident)) return -1;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    long primaryCount = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    std::cout << "sizeof: PrimaryExpr " << sizeof(PrimaryExpr) << ", BinaryExpr " << sizeof(BinaryExpr)
+              << ", UnaryExpr " << sizeof(UnaryExpr) << ", CallExpr " << sizeof(CallExpr)
+              << ", AssignStmt " << sizeof(AssignStmt) << ", DeclareStmt " << sizeof(DeclareStmt)
+              << ", Block " << sizeof(Block) << std::endl;
+
+    CompilationContext context;
+    Lexer lexer(context, makeSource(primaryCount));
+    lexer.scanTokens();
+    lexer.reset();
+
+    long before = residentKb();
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Program> program;
+    {
+        Parser parser(lexer);
+        program = parser.parse();
+    }
+    double parseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    long after = residentKb();
+
+    std::cout << "基础表达式约 " << primaryCount << " 个，解析 " << parseMs << " ms，Arena "
+              << program->arena->reservedBytes() / (1024.0 * 1024.0) << " MB";
+    if (before >= 0 && after >= 0) {
+        std::cout << "，RSS 增加 " << (after - before) / 1024.0 << " MB";
+    }
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+// keyword_bench.cpp
+// 关键字识别微基准：对比原 Lexer::keywords（unordered_map，find 后再 operator[]）
+// 与 keywords.h 中编译期生成的分桶匹配 keywordIndex()。
+// 用法: keyword_bench [轮数]
+#include "keywords.h"
+#include "token.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 原实现中的关键字表
+std::unordered_map<std::string, TokenType> makeKeywordMap() {
+    std::unordered_map<std::string, TokenType> map;
+    for (std::string_view keyword : KEYWORDS) {
+        map.emplace(std::string(keyword), TokenType::KEYWORD);
+    }
+    return map;
+}
+
+// 模拟标识符较多的源码：关键字与普通标识符约 1:3
+std::vector<std::string_view> makeWords() {
+    static const std::string_view identifiers[] = {
+        "i", "j", "count", "total", "index_value", "buffer", "printf", "result",
+        "alpha", "beta", "node", "next", "length", "is_valid", "strcmp", "data",
+        "in", "doit", "integer", "forward", "whiles", "structure", "c", "s",
+    };
+    std::vector<std::string_view> words;
+    for (int round = 0; round < 4; ++round) {
+        for (std::string_view id : identifiers) words.push_back(id);
+        for (int k = 0; k < KEYWORD_COUNT; k += 4) words.push_back(KEYWORDS[(k + round) % KEYWORD_COUNT]);
+    }
+    return words;
+}
+
+template <class Lookup>
+double measure(const std::vector<std::string_view>& words, int rounds, long& hits, Lookup lookup) {
+    auto start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (std::string_view word : words) {
+            hits += lookup(word);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    return ns / (static_cast<double>(rounds) * words.size());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 200000;
+    const auto keywordMap = makeKeywordMap();
+    auto words = makeWords();
+
+    long mapHits = 0, switchHits = 0;
+    double mapNs = measure(words, rounds, mapHits, [&](std::string_view word) {
+        std::string text(word);   // 原实现先 substr 得到 std::string
+        auto& map = const_cast<std::unordered_map<std::string, TokenType>&>(keywordMap);
+        return map.find(text) != map.end() && map[text] == TokenType::KEYWORD ? 1 : 0;
+    });
+    double switchNs = measure(words, rounds, switchHits, [](std::string_view word) {
+        return keywordIndex(word) >= 0 ? 1 : 0;
+    });
+
+    if (mapHits != switchHits) {
+        std::cerr << "结果不一致: " << mapHits << " != " << switchHits << std::endl;
+        return 1;
+    }
+    std::cout << "单词数 " << words.size() << " x " << rounds << " 轮\n"
+              << "unordered_map:  " << mapNs << " ns/次\n"
+              << "keywordIndex:   " << switchNs << " ns/次\n"
+              << "加速比:         " << mapNs / switchNs << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,92 @@
+// builtins.h
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include <string_view>
+#include "keywords.h"
+
+// 内置函数用到的、不是关键字的名字（函数名、参数名、类型名）。
+// Lexer 在关键字之后按此顺序预先驻留，因此编号固定为 KEYWORD_COUNT + 下标，
+// 内置函数表可以在编译期写好，所有编译共用
+inline constexpr std::string_view PREDEFINED_NAMES[] = {
+    // 函数名
+    "printf", "scanf", "puts", "gets", "strlen", "strcmp", "strcpy", "abs", "sqrt", "pow",
+    // 参数名
+    "format", "args", "str", "str1", "str2", "dest", "src", "num", "base", "exponent",
+    // 类型名
+    "string", "vararg",
+};
+inline constexpr int PREDEFINED_NAME_COUNT = sizeof(PREDEFINED_NAMES) / sizeof(PREDEFINED_NAMES[0]);
+
+// 关键字或预定义名字的固定驻留编号，其它名字返回-1
+constexpr int predefinedId(std::string_view name) {
+    int keyword = keywordIndex(name);
+    if (keyword >= 0) return keyword;
+    for (int i = 0; i < PREDEFINED_NAME_COUNT; ++i) {
+        if (PREDEFINED_NAMES[i] == name) return KEYWORD_COUNT + i;
+    }
+    return -1;
+}
+
+inline constexpr int BUILTIN_MAX_PARAMS = 2;
+
+struct BuiltinFunction {
+    int name;                                // 函数名
+    int returnType;                          // 返回类型
+    int paramCount;
+    int paramNames[BUILTIN_MAX_PARAMS];      // 参数名
+    int paramTypes[BUILTIN_MAX_PARAMS];      // 参数类型
+};
+
+constexpr BuiltinFunction builtin(std::string_view name, std::string_view returnType) {
+    return {predefinedId(name), predefinedId(returnType), 0, {-1, -1}, {-1, -1}};
+}
+constexpr BuiltinFunction builtin(std::string_view name, std::string_view returnType,
+                                  std::string_view name1, std::string_view type1) {
+    return {predefinedId(name), predefinedId(returnType), 1,
+            {predefinedId(name1), -1}, {predefinedId(type1), -1}};
+}
+constexpr BuiltinFunction builtin(std::string_view name, std::string_view returnType,
+                                  std::string_view name1, std::string_view type1,
+                                  std::string_view name2, std::string_view type2) {
+    return {predefinedId(name), predefinedId(returnType), 2,
+            {predefinedId(name1), predefinedId(name2)}, {predefinedId(type1), predefinedId(type2)}};
+}
+
+// 内置函数表（编译期常量）
+inline constexpr BuiltinFunction BUILTIN_FUNCTIONS[] = {
+    // IO函数
+    builtin("printf", "int", "format", "string", "args", "vararg"),
+    builtin("scanf", "int", "format", "string", "args", "vararg"),
+    builtin("puts", "int", "str", "string"),
+    builtin("gets", "string", "str", "string"),
+
+    // 字符串函数
+    builtin("strlen", "int", "str", "string"),
+    builtin("strcmp", "int", "str1", "string", "str2", "string"),
+    builtin("strcpy", "string", "dest", "string", "src", "string"),
+
+    // 数学函数
+    builtin("abs", "int", "num", "int"),
+    builtin("sqrt", "double", "num", "double"),
+    builtin("pow", "double", "base", "double", "exponent", "double"),
+};
+inline constexpr int BUILTIN_FUNCTION_COUNT = sizeof(BUILTIN_FUNCTIONS) / sizeof(BUILTIN_FUNCTIONS[0]);
+
+constexpr bool builtinTableIsValid() {
+    for (int i = 0; i < PREDEFINED_NAME_COUNT; ++i) {
+        if (keywordIndex(PREDEFINED_NAMES[i]) >= 0 || predefinedId(PREDEFINED_NAMES[i]) != KEYWORD_COUNT + i) {
+            return false; // 与关键字重名或表中重复
+        }
+    }
+    for (const BuiltinFunction& f : BUILTIN_FUNCTIONS) {
+        if (f.name < 0 || f.returnType < 0) return false;
+        for (int k = 0; k < f.paramCount; ++k) {
+            if (f.paramNames[k] < 0 || f.paramTypes[k] < 0) return false;
+        }
+    }
+    return true;
+}
+static_assert(builtinTableIsValid(), "内置函数表中的名字须全部登记在 PREDEFINED_NAMES 中且不与关键字重复");
+
+#endif // BUILTINS_H
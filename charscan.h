@@ -0,0 +1,121 @@
+// charscan.h
+// 词法分析热点中的批量字符扫描：x86 上按 16/32 字节块用 SSE2/AVX2 比较，其它平台逐字符回退
+#ifndef CHARSCAN_H
+#define CHARSCAN_H
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CHARSCAN_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CHARSCAN_SSE2 1
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace charscan {
+
+inline int countTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// 标识符与数字的字符分类，Lexer 与编辑器的语法高亮共用
+inline bool isAlpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline bool isAlphaNumeric(char c) {
+    return isAlpha(c) || isDigit(c);
+}
+
+// 返回 [pos, end) 中第一个不是空格、制表符或回车的位置，全部是空白时返回 end
+inline size_t skipBlanks(const char* s, size_t pos, size_t end) {
+#ifdef CHARSCAN_AVX2
+    const __m256i space32 = _mm256_set1_epi8(' ');
+    const __m256i tab32 = _mm256_set1_epi8('\t');
+    const __m256i cr32 = _mm256_set1_epi8('\r');
+    while (pos + 32 <= end) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + pos));
+        __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, space32),
+                                        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, tab32),
+                                                        _mm256_cmpeq_epi8(chunk, cr32)));
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(blank));
+        if (mask != 0) return pos + countTrailingZeros(mask);
+        pos += 32;
+    }
+#endif
+#ifdef CHARSCAN_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (pos + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+        __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                     _mm_or_si128(_mm_cmpeq_epi8(chunk, tab),
+                                                  _mm_cmpeq_epi8(chunk, cr)));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(blank)) & 0xFFFFu;
+        if (mask != 0) return pos + countTrailingZeros(mask);
+        pos += 16;
+    }
+#endif
+    while (pos < end && isBlank(s[pos])) ++pos;
+    return pos;
+}
+
+// 返回 [pos, end) 中第一个等于 c 的位置，找不到时返回 end（memchr 已向量化）
+inline size_t find(const char* s, size_t pos, size_t end, char c) {
+    if (pos >= end) return end;
+    const void* hit = std::memchr(s + pos, c, end - pos);
+    return hit ? static_cast<size_t>(static_cast<const char*>(hit) - s) : end;
+}
+
+// 返回 [pos, end) 中第一个等于 a 或 b 的位置，找不到时返回 end
+inline size_t findEither(const char* s, size_t pos, size_t end, char a, char b) {
+#ifdef CHARSCAN_AVX2
+    const __m256i a32 = _mm256_set1_epi8(a);
+    const __m256i b32 = _mm256_set1_epi8(b);
+    while (pos + 32 <= end) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + pos));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, a32), _mm256_cmpeq_epi8(chunk, b32))));
+        if (mask != 0) return pos + countTrailingZeros(mask);
+        pos += 32;
+    }
+#endif
+#ifdef CHARSCAN_SSE2
+    const __m128i a16 = _mm_set1_epi8(a);
+    const __m128i b16 = _mm_set1_epi8(b);
+    while (pos + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + pos));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, a16), _mm_cmpeq_epi8(chunk, b16))));
+        if (mask != 0) return pos + countTrailingZeros(mask);
+        pos += 16;
+    }
+#endif
+    while (pos < end && s[pos] != a && s[pos] != b) ++pos;
+    return pos;
+}
+
+} // namespace charscan
+
+#endif // CHARSCAN_H
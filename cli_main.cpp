@@ -0,0 +1,330 @@
+// cli_main.cpp
+// 无界面批量编译工具：对命令行给出的文件（支持通配符）并行执行词法分析和语法分析，
+// 将诊断信息与耗时输出到标准输出，不创建 QApplication 与任何窗口部件。
+// 每个文件在线程池中独立编译（各用一个 CompilationContext），大文件先编译以缩短最后的等待；
+// 结果全部完成后按输入顺序输出，与线程数和调度无关。
+#include "lexer.h"
+#include "parser.h"
+#include "error.h"
+#include "diagnostics.h"
+#include "sourcebuffer.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    bool quiet = false;                // 只输出失败文件与汇总
+    bool streaming = false;            // 按需扫描，不生成完整Token数组
+    DiagnosticFormat format = DiagnosticFormat::Text;  // 诊断输出格式
+    unsigned jobs = 0;                 // 并行编译的线程数，0 表示硬件线程数
+    std::vector<std::string> inputs;   // 文件或通配符
+};
+
+void printUsage(const char* argv0) {
+    std::cout << "用法: " << argv0 << " [选项] <文件或通配符>...\n"
+              << "  -v, --verbose   输出全部调试跟踪（相当于 --trace=all:debug）\n"
+              << "      --trace=SPEC 按类别和级别输出调试跟踪到标准错误，如 parser,symbol:verbose\n"
+              << "                  （类别 lexer/parser/symbol/gui/all，级别 info/debug/verbose；\n"
+              << "                   高于编译期 COMPILER_TRACE_LEVEL 的跟踪不可用）\n"
+              << "  -q, --quiet     只输出失败的文件和汇总信息\n"
+              << "  -s, --stream    边解析边扫描Token（内存占用与文件大小无关，词法耗时计入语法）\n"
+              << "  -j, --jobs=N    同时编译的文件数（默认为硬件线程数）\n"
+              << "      --format=FMT 诊断输出格式：text（默认）、json 或 sarif；\n"
+              << "                  json/sarif 时标准输出只含诊断文档，统计信息改写到标准错误\n"
+              << "  -h, --help      显示本帮助\n";
+}
+
+// 简单通配符匹配（支持 * 与 ?）
+bool wildcardMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0, t = 0, starP = std::string::npos, starT = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starT = t;
+        } else if (starP != std::string::npos) {
+            p = starP + 1;
+            t = ++starT;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+// 展开输入参数：Windows 的命令行不会替我们展开通配符，这里统一处理文件名部分的 * 和 ?
+void expandInput(const std::string& input, std::vector<std::string>& files) {
+    if (input.find_first_of("*?") == std::string::npos) {
+        files.push_back(input);
+        return;
+    }
+
+    fs::path path(input);
+    fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+    std::string pattern = path.filename().string();
+
+    std::error_code ec;
+    std::vector<std::string> matched;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        if (wildcardMatch(pattern, entry.path().filename().string())) {
+            matched.push_back(path.has_parent_path() ? entry.path().string()
+                                                     : entry.path().filename().string());
+        }
+    }
+    if (matched.empty()) {
+        std::cerr << input << ": 没有匹配的文件" << std::endl;
+        return;
+    }
+    std::sort(matched.begin(), matched.end()); // 保证输出顺序稳定
+    files.insert(files.end(), matched.begin(), matched.end());
+}
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// 解析 -j/--jobs 的参数，必须是正整数
+bool parseJobs(const std::string& text, unsigned& jobs) {
+    char* end = nullptr;
+    unsigned long value = std::strtoul(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value == 0 || value > 1024) return false;
+    jobs = static_cast<unsigned>(value);
+    return true;
+}
+
+// 编译单个文件的统计结果
+struct FileResult {
+    bool ok = true;
+    size_t tokenCount = 0;
+    size_t bytes = 0;
+    double lexMs = 0;
+    double parseMs = 0;
+    double totalMs = 0;             // 含读文件在内的单文件耗时
+    FileDiagnostics diagnostics;    // 本文件的全部错误（结构化记录）
+};
+
+// filePool 非空时在文件内部并行：大文件分块扫描Token、函数体并行解析
+// （只用于单个输入文件，此时编译不在线程池的任务中）
+FileResult compileFile(const std::string& path, const Options& options, ThreadPool* filePool = nullptr) {
+    FileResult result;
+    result.diagnostics.path = path;
+    auto start = Clock::now();
+    SourceBuffer source;
+    try {
+        source = SourceBuffer::fromFile(path);  // 只读映射，词法分析直接在映射上进行
+    } catch (const std::exception& e) {
+        result.diagnostics.errors.push_back({ErrorType::IO_ERROR, 0, 0, e.what()});
+        result.ok = false;
+        result.totalMs = elapsedMs(start, Clock::now());
+        return result;
+    }
+    result.bytes = source.view().size();
+
+    CompilationContext context;     // 每个文件独立的编译状态
+    Lexer lexer(context, std::move(source));
+    try {
+        auto lexStart = Clock::now();
+        if (options.streaming) {
+            lexer.enableStreaming();
+        } else {
+            result.tokenCount = (filePool ? lexer.scanTokens(*filePool) : lexer.scanTokens()).size();
+            lexer.reset();
+        }
+        auto parseStart = Clock::now();
+        result.lexMs = elapsedMs(lexStart, parseStart);
+
+        Parser parser(lexer);
+        if (filePool) {
+            parser.parse(*filePool);
+        } else {
+            parser.parse();
+        }
+        result.parseMs = elapsedMs(parseStart, Clock::now());
+        if (options.streaming) {
+            // 解析器读到最后的结束标记之前就可能结束（如 parseProgram 在没有剩余Token时退出）；取完剩余的Token，
+            // 计数与完整模式的 scanTokens().size() 一致（含结束标记）
+            while (lexer.hasNext()) lexer.nextToken();
+            result.tokenCount = lexer.streamedTokenCount();
+        }
+    } catch (const std::exception& e) {
+        // 解析器不再以异常报告源码错误，这里只剩内部错误
+        context.errors().addError(ErrorType::INTERNAL_ERROR, 0, 0, e.what());
+    }
+
+    result.diagnostics.errors = context.errors().takeErrors();
+    if (!result.diagnostics.errors.empty()) {
+        result.ok = false;
+    }
+    result.totalMs = elapsedMs(start, Clock::now());
+    return result;
+}
+
+// 已排序耗时的百分位数（最近秩法）
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    if (rank == 0) rank = 1;
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+// 文本格式：逐文件输出诊断与耗时
+void printTextResult(const FileResult& result, const Options& options) {
+    writeDiagnosticsText(std::cout, result.diagnostics);
+    if (result.ok && !options.quiet) {
+        std::cout << result.diagnostics.path << ": 通过（Token: " << result.tokenCount
+                  << ", 词法: " << result.lexMs << " ms, 语法: " << result.parseMs << " ms）"
+                  << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+    SetConsoleOutputCP(65001);
+#endif
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "-v" || arg == "--verbose") {
+            trace::enable(trace::All, trace::Level::Debug);
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            if (!trace::configure(std::string_view(arg).substr(8))) {
+                std::cerr << "无效的跟踪配置: " << arg << std::endl;
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (arg == "-q" || arg == "--quiet") {
+            options.quiet = true;
+        } else if (arg == "-s" || arg == "--stream") {
+            options.streaming = true;
+        } else if (arg.rfind("-j", 0) == 0 || arg.rfind("--jobs=", 0) == 0) {
+            std::string value;
+            if (arg == "-j") {
+                value = i + 1 < argc ? argv[++i] : "";
+            } else {
+                value = arg.substr(arg[1] == 'j' ? 2 : 7);
+            }
+            if (!parseJobs(value, options.jobs)) {
+                std::cerr << "无效的线程数: " << arg << std::endl;
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (arg.rfind("--format=", 0) == 0) {
+            if (!parseDiagnosticFormat(std::string_view(arg).substr(9), options.format)) {
+                std::cerr << "未知的输出格式: " << arg << std::endl;
+                printUsage(argv[0]);
+                return 2;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "未知选项: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.inputs.empty()) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> files;
+    for (const auto& input : options.inputs) {
+        expandInput(input, files);
+    }
+
+    // 按文件大小从大到小提交：耗时最长的文件最先开始，不会在最后拖住整批编译
+    std::vector<std::pair<uintmax_t, size_t>> order;    // (字节数, 输入下标)
+    order.reserve(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        std::error_code ec;
+        uintmax_t size = fs::file_size(files[i], ec);
+        order.emplace_back(ec ? 0 : size, i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<FileResult> results(files.size());
+    auto start = Clock::now();
+    ThreadPool pool(options.jobs);
+    if (files.size() == 1) {
+        // 只有一个文件时改为在文件内部并行：分块扫描Token、并行解析函数体
+        results[0] = compileFile(files[0], options, &pool);
+    } else {
+        for (const auto& entry : order) {
+            size_t index = entry.second;
+            pool.submit([&, index] { results[index] = compileFile(files[index], options); });
+        }
+        pool.wait();
+    }
+    double totalMs = elapsedMs(start, Clock::now());
+
+    // 按输入顺序合并结果，输出与调度顺序无关
+    size_t failed = 0, totalTokens = 0, totalBytes = 0;
+    double totalLexMs = 0, totalParseMs = 0;
+    bool machineReadable = options.format != DiagnosticFormat::Text;
+    std::vector<FileDiagnostics> diagnostics;   // json/sarif：全部文件编译完后一次写出
+    std::vector<double> latencies;
+    latencies.reserve(results.size());
+    for (FileResult& result : results) {
+        if (!result.ok) ++failed;
+        totalTokens += result.tokenCount;
+        totalBytes += result.bytes;
+        totalLexMs += result.lexMs;
+        totalParseMs += result.parseMs;
+        latencies.push_back(result.totalMs);
+        if (machineReadable) {
+            diagnostics.push_back(std::move(result.diagnostics));
+        } else {
+            printTextResult(result, options);
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    if (options.format == DiagnosticFormat::Json) {
+        writeDiagnosticsJson(std::cout, diagnostics);
+    } else if (options.format == DiagnosticFormat::Sarif) {
+        writeDiagnosticsSarif(std::cout, diagnostics);
+    }
+    std::ostream& summary = machineReadable ? std::cerr : std::cout;
+    summary << "共 " << files.size() << " 个文件，失败 " << failed
+              << " 个；Token " << totalTokens
+              << "；词法 " << totalLexMs << " ms，语法 " << totalParseMs
+              << " ms，总计 " << totalMs << " ms" << std::endl;
+    // 词法/语法耗时是各线程累加的 CPU 时间，总计是墙钟时间；吞吐量按墙钟时间计算
+    double seconds = totalMs / 1000.0;
+    summary << "线程 " << pool.size() << "；吞吐 "
+            << (seconds > 0 ? files.size() / seconds : 0) << " 文件/s，"
+            << (seconds > 0 ? totalBytes / (1024.0 * 1024.0) / seconds : 0) << " MB/s"
+            << "；单文件耗时 p50 " << percentile(latencies, 50) << " ms，p90 "
+            << percentile(latencies, 90) << " ms，p99 " << percentile(latencies, 99)
+            << " ms，最大 " << (latencies.empty() ? 0 : latencies.back()) << " ms" << std::endl;
+    return failed == 0 && !files.empty() ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+// compilation.cpp
+#include "compilation.h"
+#include "builtins.h"
+#include "keywords.h"
+
+CompilationContext::CompilationContext()
+    : interner(std::make_shared<StringInterner>()),
+      astArena(std::make_shared<Arena>()),
+      symbolTable(*interner) {
+    // 关键字编号即其在 KEYWORDS 中的下标，内置函数用到的名字紧随其后
+    for (std::string_view keyword : KEYWORDS) {
+        interner->intern(keyword);
+    }
+    for (std::string_view name : PREDEFINED_NAMES) {
+        interner->intern(name);
+    }
+}
+
+void CompilationContext::reset() {
+    errorList.clear();
+    symbolTable.clear();
+    astArena = std::make_shared<Arena>();
+}
@@ -0,0 +1,46 @@
+// compilation.h
+#ifndef COMPILATION_H
+#define COMPILATION_H
+
+#include <memory>
+#include "arena.h"
+#include "error.h"
+#include "interner.h"
+#include "symbol.h"
+
+// 一个翻译单元的编译状态：错误列表、驻留表、AST 竞技场和符号表。
+// Lexer 与 Parser 都通过它读写这些状态，不存在进程级的共享对象，
+// 因此不同文件各用一个 CompilationContext 即可在不同线程中同时编译，无需加锁。
+// 驻留表和竞技场以共享指针持有，解析得到的 Program 引用它们，可比 CompilationContext 活得更久
+class CompilationContext {
+public:
+    CompilationContext();
+    CompilationContext(const CompilationContext&) = delete;
+    CompilationContext& operator=(const CompilationContext&) = delete;
+
+    ErrorManager& errors() { return errorList; }
+    const ErrorManager& errors() const { return errorList; }
+
+    // 标识符/关键字驻留表：已预先驻留关键字和内置函数用到的名字，编号固定
+    StringInterner& names() { return *interner; }
+    const StringInterner& names() const { return *interner; }
+    std::shared_ptr<StringInterner> sharedNames() const { return interner; }
+
+    // AST 节点的竞技场
+    Arena& arena() { return *astArena; }
+    std::shared_ptr<Arena> sharedArena() const { return astArena; }
+
+    SymbolTable& symbols() { return symbolTable; }
+
+    // 在同一份源码上重新编译前调用（如编辑器中增量扫描后再次解析）：清空错误列表和符号表，
+    // AST 改用新的竞技场。驻留表保留，Lexer 中已有Token的编号仍然有效；之前得到的 Program 仍持有旧竞技场
+    void reset();
+
+private:
+    ErrorManager errorList;
+    std::shared_ptr<StringInterner> interner;
+    std::shared_ptr<Arena> astArena;
+    SymbolTable symbolTable;    // 引用 interner，须在其后声明
+};
+
+#endif // COMPILATION_H
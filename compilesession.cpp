@@ -0,0 +1,64 @@
+// compilesession.cpp
+#include "compilesession.h"
+#include <chrono>
+#include <exception>
+#include "parser.h"
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+CompileSession::CompileSession()
+    : context(std::make_unique<CompilationContext>()),
+      lexer(std::make_unique<Lexer>(*context, std::string())) {
+    lexer->scanTokens();
+}
+
+std::shared_ptr<const CompileSnapshot> CompileSession::compile(std::string_view text,
+                                                               const std::atomic<bool>& cancelled) {
+    if (cancelled.load()) return nullptr;
+    auto snapshot = std::make_shared<CompileSnapshot>();
+    try {
+        auto lexStart = std::chrono::steady_clock::now();
+        lexer->updateText(text);
+        context->reset();
+        lexer->reportLexicalErrors();
+        snapshot->lexMs = elapsedMs(lexStart);
+        if (cancelled.load()) return nullptr;
+
+        auto parseStart = std::chrono::steady_clock::now();
+        lexer->reset();
+        Parser parser(*lexer);
+        snapshot->program = parser.parse();
+        snapshot->parseMs = elapsedMs(parseStart);
+        if (cancelled.load()) return nullptr;
+    } catch (const std::exception& e) {
+        snapshot->internalError = e.what();
+    }
+
+    // Token 的值改为指向快照自己的源码副本；AST 的文本在竞技场中，下次编译换用新的竞技场，
+    // 只有驻留表仍会被下次编译修改，复制一份
+    snapshot->source = std::string(lexer->text());
+    std::string_view source = snapshot->source;
+    const std::vector<Token>& tokens = lexer->tokenArray();
+    snapshot->tokens.reserve(tokens.size());
+    snapshot->locations.reserve(tokens.size());
+    for (Token token : tokens) {
+        if (valueInSource(token)) {
+            token.value = source.substr(valueOffset(token), token.value.size());
+        } else if (token.type == TokenType::STRING) {
+            token.value = snapshot->decodedStrings.emplace_back(token.value);
+        }
+        snapshot->tokens.push_back(token);
+        snapshot->locations.push_back(lexer->location(token));
+    }
+    if (snapshot->program) {
+        snapshot->program->names = std::make_shared<const StringInterner>(context->names());
+    }
+    snapshot->errors = context->errors().getErrors();
+    return snapshot;
+}
@@ -0,0 +1,46 @@
+// compilesession.h
+#ifndef COMPILESESSION_H
+#define COMPILESESSION_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast.h"
+#include "compilation.h"
+#include "error.h"
+#include "lexer.h"
+#include "token.h"
+
+// 一次编译的结果。生成后不再修改，也不引用 CompileSession 的任何状态：
+// 工作线程生成后交给 GUI 线程显示，此时工作线程可以已经开始下一次编译
+struct CompileSnapshot {
+    std::string source;                     // 编译时的源码，Token 的值指向这里
+    std::list<std::string> decodedStrings;  // 含转义的字符串字面量的解码结果
+    std::vector<Token> tokens;
+    std::vector<SourceLocation> locations;  // 与 tokens 一一对应的行列号
+    std::unique_ptr<Program> program;       // 名字表是编译时驻留表的副本
+    std::vector<Error> errors;
+    std::string internalError;              // 编译器内部错误（没有源码位置），为空表示没有
+    double lexMs = 0;
+    double parseMs = 0;
+};
+
+// 编辑器中同一份源码的反复编译：保留上次的 Token，再次编译时只增量扫描改动的部分。
+// 同一时刻只能有一个线程调用 compile()
+class CompileSession {
+public:
+    CompileSession();
+
+    // 编译 text 并生成快照。cancelled 在各阶段之间检查，置位后尽快返回空指针；
+    // 被取消时已完成的增量扫描仍然保留，下次编译照常使用
+    std::shared_ptr<const CompileSnapshot> compile(std::string_view text, const std::atomic<bool>& cancelled);
+
+private:
+    std::unique_ptr<CompilationContext> context;
+    std::unique_ptr<Lexer> lexer;
+};
+
+#endif // COMPILESESSION_H
@@ -0,0 +1,175 @@
+// diagnostics.cpp
+#include "diagnostics.h"
+#include <cstdio>
+
+namespace {
+
+struct ErrorTypeInfo {
+    ErrorType type;
+    const char* id;
+    const char* description;
+};
+
+// SARIF 的规则表按此顺序输出，ruleIndex 即下标
+const ErrorTypeInfo ERROR_TYPES[] = {
+    {ErrorType::UNDEFINED_VARIABLE, "undefined-variable", "未定义的变量或函数"},
+    {ErrorType::DUPLICATE_DECLARATION, "duplicate-declaration", "重复声明"},
+    {ErrorType::TYPE_MISMATCH, "type-mismatch", "类型不匹配"},
+    {ErrorType::INVALID_OPERATION, "invalid-operation", "无效操作"},
+    {ErrorType::SYNTAX_ERROR, "syntax-error", "语法错误"},
+    {ErrorType::LEXICAL_ERROR, "lexical-error", "词法错误"},
+    {ErrorType::IO_ERROR, "io-error", "无法读取源文件"},
+    {ErrorType::INTERNAL_ERROR, "internal-error", "编译器内部错误"},
+};
+constexpr int ERROR_TYPE_COUNT = sizeof(ERROR_TYPES) / sizeof(ERROR_TYPES[0]);
+
+int errorTypeIndex(ErrorType type) {
+    for (int i = 0; i < ERROR_TYPE_COUNT; ++i) {
+        if (ERROR_TYPES[i].type == type) return i;
+    }
+    return -1;
+}
+
+// 写出 JSON 字符串（含两侧引号）；UTF-8 原样输出，只转义引号、反斜杠和控制字符
+void writeJsonString(std::ostream& out, std::string_view text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                out << escaped;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+bool parseDiagnosticFormat(std::string_view name, DiagnosticFormat& format) {
+    if (name == "text") format = DiagnosticFormat::Text;
+    else if (name == "json") format = DiagnosticFormat::Json;
+    else if (name == "sarif") format = DiagnosticFormat::Sarif;
+    else return false;
+    return true;
+}
+
+// 文件路径转为 SARIF 的 URI。绝对路径写成 file: URI（/a.c → file:///a.c，C:\a.c → file:///C:/a.c，
+// \\host\a.c → file://host/a.c），相对路径写成相对引用。反斜杠改为'/'，
+// 保留字符以外的字节按 %XX 编码；':' 也编码，否则相对路径中的 "a:b" 会被读作 scheme
+std::string pathToUri(std::string_view path) {
+    static const char HEX[] = "0123456789ABCDEF";
+    auto isSeparator = [](char c) { return c == '/' || c == '\\'; };
+    std::string uri;
+    uri.reserve(path.size() + 8);
+    if (path.size() >= 3 && ((path[0] >= 'A' && path[0] <= 'Z') || (path[0] >= 'a' && path[0] <= 'z')) &&
+        path[1] == ':' && isSeparator(path[2])) {
+        uri = "file:///";
+        uri += path[0];
+        uri += ':';
+        path.remove_prefix(2);
+    } else if (path.size() >= 2 && isSeparator(path[0]) && isSeparator(path[1])) {
+        uri = "file:";      // UNC 路径的主机名作为 authority
+    } else if (!path.empty() && isSeparator(path[0])) {
+        uri = "file://";
+    }
+    for (char c : path) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '\\') {
+            uri += '/';
+        } else if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                   c == '-' || c == '_' || c == '.' || c == '~' || c == '/') {
+            uri += c;
+        } else {
+            uri += '%';
+            uri += HEX[byte >> 4];
+            uri += HEX[byte & 0xF];
+        }
+    }
+    return uri;
+}
+
+const char* errorTypeId(ErrorType type) {
+    int index = errorTypeIndex(type);
+    return index >= 0 ? ERROR_TYPES[index].id : "error";
+}
+
+void writeDiagnosticsText(std::ostream& out, const FileDiagnostics& file) {
+    for (const Error& error : file.errors) {
+        out << file.path;
+        if (error.line > 0) {
+            out << ":" << error.line << ":" << error.column;
+        }
+        out << ": 错误: " << error.message << '\n';
+    }
+}
+
+void writeDiagnosticsJson(std::ostream& out, const std::vector<FileDiagnostics>& files) {
+    out << "{\"files\":[";
+    for (size_t f = 0; f < files.size(); ++f) {
+        if (f) out << ',';
+        out << "\n{\"path\":";
+        writeJsonString(out, files[f].path);
+        out << ",\"errors\":[";
+        const std::vector<Error>& errors = files[f].errors;
+        for (size_t i = 0; i < errors.size(); ++i) {
+            const Error& error = errors[i];
+            if (i) out << ',';
+            out << "\n  {\"type\":\"" << errorTypeId(error.type) << "\",\"line\":" << error.line
+                << ",\"column\":" << error.column << ",\"offset\":" << error.offset
+                << ",\"length\":" << error.length << ",\"message\":";
+            writeJsonString(out, error.message);
+            out << '}';
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+}
+
+void writeDiagnosticsSarif(std::ostream& out, const std::vector<FileDiagnostics>& files) {
+    out << "{\"version\":\"2.1.0\","
+           "\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+           "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"CompilerFrontend2\",\"rules\":[";
+    for (int i = 0; i < ERROR_TYPE_COUNT; ++i) {
+        if (i) out << ',';
+        out << "{\"id\":\"" << ERROR_TYPES[i].id << "\",\"shortDescription\":{\"text\":";
+        writeJsonString(out, ERROR_TYPES[i].description);
+        out << "}}";
+    }
+    out << "]}},\"results\":[";
+    bool first = true;
+    for (const FileDiagnostics& file : files) {
+        std::string uri = pathToUri(file.path);
+        for (const Error& error : file.errors) {
+            if (!first) out << ',';
+            first = false;
+            out << "\n{\"ruleId\":\"" << errorTypeId(error.type) << "\"";
+            int ruleIndex = errorTypeIndex(error.type);
+            if (ruleIndex >= 0) out << ",\"ruleIndex\":" << ruleIndex;
+            out << ",\"level\":\"error\",\"message\":{\"text\":";
+            writeJsonString(out, error.message);
+            out << "},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+            writeJsonString(out, uri);
+            out << '}';
+            if (error.line > 0) {
+                // 列号按字节计，与 byteOffset 一致；纯 ASCII 源码下与 SARIF 默认的列单位相同
+                out << ",\"region\":{\"startLine\":" << error.line << ",\"startColumn\":" << error.column;
+                if (error.offset >= 0) {
+                    out << ",\"byteOffset\":" << error.offset << ",\"byteLength\":" << error.length;
+                }
+                out << '}';
+            }
+            out << "}}]}";
+        }
+    }
+    out << "\n]}]}\n";
+}
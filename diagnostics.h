@@ -0,0 +1,39 @@
+// diagnostics.h
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "error.h"
+
+// 诊断输出：把 ErrorManager 收集的结构化错误写成人读的文本，或供编辑器/CI 等工具读取的 JSON、SARIF 2.1.0
+
+enum class DiagnosticFormat {
+    Text,   // 每行一条：文件:行:列: 错误: 信息
+    Json,   // {"files":[{"path":...,"errors":[...]}]}
+    Sarif,  // SARIF 2.1.0，每条错误对应一个 result
+};
+
+// 由名字（text/json/sarif）得到输出格式，未知名字返回 false
+bool parseDiagnosticFormat(std::string_view name, DiagnosticFormat& format);
+
+// 错误类型的稳定标识（如 "syntax-error"），用作 JSON 的 type 与 SARIF 的 ruleId
+const char* errorTypeId(ErrorType type);
+
+// 文件路径转为 SARIF artifactLocation 的 uri：绝对路径（含 Windows 盘符和 UNC 路径）为 file: URI，
+// 相对路径为相对引用
+std::string pathToUri(std::string_view path);
+
+// 一个源文件的全部诊断
+struct FileDiagnostics {
+    std::string path;
+    std::vector<Error> errors;
+};
+
+void writeDiagnosticsText(std::ostream& out, const FileDiagnostics& file);
+void writeDiagnosticsJson(std::ostream& out, const std::vector<FileDiagnostics>& files);
+void writeDiagnosticsSarif(std::ostream& out, const std::vector<FileDiagnostics>& files);
+
+#endif // DIAGNOSTICS_H
@@ -9,26 +9,34 @@ enum class ErrorType {
     TYPE_MISMATCH,          // 类型不匹配
     INVALID_OPERATION,      // 无效操作（如对字符串做减法）
     SYNTAX_ERROR,           // 语法错误
+    LEXICAL_ERROR,          // 词法错误（无法识别的字符、未闭合的字符串）
+    IO_ERROR,               // 无法读取源文件
+    INTERNAL_ERROR,         // 编译器内部错误
     // 其他错误类型...
 };
 
+// 结构化的错误记录：位置单独保存，不拼接在 message 中，GUI、命令行和外部工具直接读取字段
 struct Error {
     ErrorType type;
-    int line;       // 错误行号
-    int column;     // 错误列号
-    std::string message;  // 错误信息
+    int line;       // 错误行号（从1开始，与文件整体相关的错误为0）
+    int column;     // 错误列号（从1开始，按字节计）
+    std::string message;  // 错误信息（不含位置）
+    int offset = -1;      // 出错源码片段的起始字节偏移，未知时为-1
+    int length = 0;       // 出错源码片段的字节长度
 };
 // ErrorManager.h
+// 一次编译（一个翻译单元）的错误列表，由 CompilationContext 持有；不同文件各有一份，可在不同线程中同时使用
 class ErrorManager {
 public:
-    static ErrorManager& instance() {
-        static ErrorManager instance;
-        return instance;
-    }
+    ErrorManager() = default;
 
     void addError(ErrorType type, int line, int column, const std::string& msg) {
         errors.push_back({type, line, column, msg});
     }
+    // 附带源码片段（通常是出错的Token）
+    void addError(ErrorType type, int line, int column, int offset, int length, const std::string& msg) {
+        errors.push_back({type, line, column, msg, offset, length});
+    }
 
     const std::vector<Error>& getErrors() const {
         return errors;
@@ -42,10 +50,17 @@ public:
         errors.clear();
     }
 
-private:
-    std::vector<Error> errors;
-    ErrorManager() = default;
+    // 取走已收集的错误（之后列表为空），供一个文件编译结束后转交给输出端
+    std::vector<Error> takeErrors() {
+        std::vector<Error> taken;
+        taken.swap(errors);
+        return taken;
+    }
+
     ErrorManager(const ErrorManager&) = delete;
     ErrorManager& operator=(const ErrorManager&) = delete;
+
+private:
+    std::vector<Error> errors;
 };
 #endif // ERROR_H
@@ -0,0 +1,183 @@
+// highlightscan.h
+// 编辑器语法高亮的逐行扫描：按 Lexer 的规则找出关键字、数字、字符串、注释和函数名。
+// 不依赖 Qt，文本为 UTF-16（与 QString 的存储相同），CodeHighlighter 与测试共用
+#ifndef HIGHLIGHTSCAN_H
+#define HIGHLIGHTSCAN_H
+
+#include "charscan.h"
+#include "keywords.h"
+#include <string_view>
+
+namespace highlightscan {
+
+// 行末所处的状态（QSyntaxHighlighter 的块状态初始为 -1，与其它未列出的值一样按 Normal 处理）
+enum LineState {
+    Normal = 0,
+    InBlockComment = 1,     // 块注释未结束
+    InString = 2,           // 字符串未闭合（与 Lexer 相同，字符串可以跨行）
+};
+
+enum class Kind { Keyword, Number, String, Comment, Function };
+
+// Lexer 按字节分类，非 ASCII 字符都不是标识符字符；这里换成 '\0' 按其它字符处理
+inline char asciiAt(const char16_t* text, int i) {
+    return text[i] < 0x80 ? static_cast<char>(text[i]) : '\0';
+}
+
+// 行注释的结束位置：与 Lexer 相同，在回车处结束（其后照常扫描），没有回车时到行末
+inline int lineCommentEnd(const char16_t* text, int from, int length) {
+    for (int i = from; i < length; ++i) {
+        if (text[i] == u'\r') return i;
+    }
+    return length;
+}
+
+// 从 from 开始找块注释的结束符，返回其后的位置；本行没有结束时返回 -1
+inline int blockCommentEnd(const char16_t* text, int from, int length) {
+    for (int i = from; i + 1 < length; ++i) {
+        if (text[i] == u'*' && text[i + 1] == u'/') return i + 2;
+    }
+    return -1;
+}
+
+// 从 from 开始找字符串的闭合引号，返回其后的位置；本行没有闭合时返回 -1。
+// 反斜杠跳过下一个字符，行末的反斜杠跳过的是换行符
+inline int stringEnd(const char16_t* text, int from, int length) {
+    for (int i = from; i < length; ++i) {
+        if (text[i] == u'\\') {
+            ++i;
+        } else if (text[i] == u'"') {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+// 从左到右扫描一遍：每个字符只看一次，耗时与行长成正比。state 为上一行的行末状态，
+// 对每个要高亮的片段按从左到右的顺序调用 emit(start, length, kind)，返回本行的行末状态。
+// 标识符后（隔着空白或注释）紧跟'('时是函数名；'(' 在后面的行时无法判断，不作函数名
+template <typename Emit>
+int scanLine(const char16_t* text, int length, int state, Emit&& emit) {
+    int i = 0;
+
+    // 先接着上一行未结束的块注释或字符串
+    if (state == InBlockComment || state == InString) {
+        Kind kind = state == InBlockComment ? Kind::Comment : Kind::String;
+        int end = state == InBlockComment ? blockCommentEnd(text, 0, length) : stringEnd(text, 0, length);
+        if (end < 0) {
+            emit(0, length, kind);
+            return state;
+        }
+        emit(0, end, kind);
+        i = end;
+    }
+
+    // 最近一个标识符：后面的第一个Token是'('时它是函数名
+    int identStart = -1;
+    int identLength = 0;
+
+    while (i < length) {
+        char c = asciiAt(text, i);
+        if (charscan::isBlank(c)) {
+            ++i;
+            continue;
+        }
+
+        if (c == '/' && i + 1 < length && text[i + 1] == u'/') {
+            int end = lineCommentEnd(text, i + 2, length);
+            emit(i, end - i, Kind::Comment);
+            i = end;
+            continue;
+        }
+        if (c == '/' && i + 1 < length && text[i + 1] == u'*') {
+            // 注释在 Lexer 中与空白一样被跳过，不影响前面的标识符是否为函数名
+            int end = blockCommentEnd(text, i + 2, length);
+            if (end < 0) {
+                emit(i, length - i, Kind::Comment);
+                return InBlockComment;
+            }
+            emit(i, end - i, Kind::Comment);
+            i = end;
+            continue;
+        }
+
+        if (charscan::isAlpha(c)) {
+            int start = i;
+            while (i < length && charscan::isAlphaNumeric(asciiAt(text, i))) ++i;
+            int wordLength = i - start;
+            // 关键字最长 KEYWORD_MAX_LENGTH 个字符，更长的不必查表
+            if (wordLength <= KEYWORD_MAX_LENGTH) {
+                char word[KEYWORD_MAX_LENGTH];
+                for (int k = 0; k < wordLength; ++k) word[k] = asciiAt(text, start + k);
+                if (keywordIndex(std::string_view(word, wordLength)) >= 0) {
+                    emit(start, wordLength, Kind::Keyword);
+                    identStart = -1;
+                    continue;
+                }
+            }
+            identStart = start;
+            identLength = wordLength;
+            continue;
+        }
+
+        if (c == '(' && identStart >= 0) {
+            emit(identStart, identLength, Kind::Function);
+        }
+        identStart = -1;
+
+        if (charscan::isDigit(c)) {
+            // 与 Lexer::number() 相同：整数部分，以及'.'后跟数字时的小数部分
+            int start = i;
+            while (i < length && charscan::isDigit(asciiAt(text, i))) ++i;
+            if (i + 1 < length && text[i] == u'.' && charscan::isDigit(asciiAt(text, i + 1))) {
+                i += 2;
+                while (i < length && charscan::isDigit(asciiAt(text, i))) ++i;
+            }
+            emit(start, i - start, Kind::Number);
+            continue;
+        }
+
+        if (c == '"') {
+            int end = stringEnd(text, i + 1, length);
+            if (end < 0) {
+                emit(i, length - i, Kind::String);
+                return InString;
+            }
+            emit(i, end - i, Kind::String);
+            i = end;
+            continue;
+        }
+
+        ++i;
+    }
+    return Normal;
+}
+
+// 只计算行末状态，结果与 scanLine() 相同：标识符、数字和运算符中不会出现 '/' 和 '"'，
+// 普通代码中只需在这两个字符处停下
+inline int endState(const char16_t* text, int length, int state) {
+    int i = 0;
+    if (state == InBlockComment || state == InString) {
+        i = state == InBlockComment ? blockCommentEnd(text, 0, length) : stringEnd(text, 0, length);
+        if (i < 0) return state;
+    }
+    while (i < length) {
+        char16_t c = text[i];
+        if (c == u'"') {
+            i = stringEnd(text, i + 1, length);
+            if (i < 0) return InString;
+        } else if (c == u'/' && i + 1 < length && text[i + 1] == u'/') {
+            i = lineCommentEnd(text, i + 2, length);
+        } else if (c == u'/' && i + 1 < length && text[i + 1] == u'*') {
+            i = blockCommentEnd(text, i + 2, length);
+            if (i < 0) return InBlockComment;
+        } else {
+            ++i;
+        }
+    }
+    return Normal;
+}
+
+} // namespace highlightscan
+
+#endif // HIGHLIGHTSCAN_H
@@ -0,0 +1,24 @@
+// interner.cpp
+#include "interner.h"
+
+StringInterner::StringInterner(const StringInterner& other) : names(other.names) {
+    ids.reserve(names.size());
+    for (size_t id = 0; id < names.size(); ++id) {
+        ids.emplace(names[id], static_cast<int>(id));
+    }
+}
+
+int StringInterner::intern(std::string_view text) {
+    auto it = ids.find(text);
+    if (it != ids.end()) return it->second;
+
+    int id = static_cast<int>(names.size());
+    names.emplace_back(text);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+int StringInterner::find(std::string_view text) const {
+    auto it = ids.find(text);
+    return it != ids.end() ? it->second : -1;
+}
@@ -0,0 +1,31 @@
+// interner.h
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 字符串驻留表：相同的标识符/关键字只保存一份，并分配稳定的整数编号
+class StringInterner {
+public:
+    StringInterner() = default;
+    // 复制出的驻留表编号不变，键改为指向自己保存的字符串（如交给其他线程只读使用的快照）
+    StringInterner(const StringInterner& other);
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // 返回文本对应的编号，首次出现时复制一份并分配新编号
+    int intern(std::string_view text);
+    // 查找已驻留的文本，不存在时返回-1（不分配）
+    int find(std::string_view text) const;
+    // 按编号取回文本，返回的视图在驻留表生命周期内有效
+    std::string_view str(int id) const { return names[id]; }
+    int size() const { return static_cast<int>(names.size()); }
+
+private:
+    std::deque<std::string> names;                  // deque 保证已存字符串地址不变
+    std::unordered_map<std::string_view, int> ids;  // 键指向 names 中的字符串
+};
+
+#endif // INTERNER_H
@@ -0,0 +1,75 @@
+// keywords.h
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include <string_view>
+
+// 关键字表：下标即关键字在驻留表中的编号（Lexer 构造时按此顺序预先驻留）
+inline constexpr std::string_view KEYWORDS[] = {
+    // 控制流关键字
+    "if", "else", "switch", "case", "default", "break", "continue", "goto", "return",
+    // 循环关键字
+    "for", "while", "do",
+    // 数据类型关键字
+    "int", "char", "float", "double", "void", "short", "long", "signed", "unsigned",
+    "enum", "struct", "union",
+    // 存储类关键字
+    "auto", "static", "register", "extern", "typedef",
+    // 类型修饰符
+    "const", "volatile",
+    // 运算符关键字
+    "sizeof",
+};
+inline constexpr int KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+inline constexpr int KEYWORD_MAX_LENGTH = 8;
+
+// 按（长度，首字母）分桶的关键字下标，编译期由 KEYWORDS 生成
+struct KeywordBuckets {
+    unsigned char begin[KEYWORD_MAX_LENGTH + 1][26] = {};
+    unsigned char count[KEYWORD_MAX_LENGTH + 1][26] = {};
+    unsigned char order[KEYWORD_COUNT] = {};
+};
+
+constexpr KeywordBuckets makeKeywordBuckets() {
+    KeywordBuckets buckets;
+    int n = 0;
+    for (int len = 0; len <= KEYWORD_MAX_LENGTH; ++len) {
+        for (int c = 0; c < 26; ++c) {
+            buckets.begin[len][c] = static_cast<unsigned char>(n);
+            for (int i = 0; i < KEYWORD_COUNT; ++i) {
+                if (static_cast<int>(KEYWORDS[i].size()) == len && KEYWORDS[i][0] == 'a' + c) {
+                    buckets.order[n++] = static_cast<unsigned char>(i);
+                }
+            }
+            buckets.count[len][c] = static_cast<unsigned char>(n - buckets.begin[len][c]);
+        }
+    }
+    return buckets;
+}
+
+inline constexpr KeywordBuckets KEYWORD_BUCKETS = makeKeywordBuckets();
+
+// 返回关键字下标，不是关键字时返回-1；只做长度/首字母分派和至多几次定长比较，不哈希、不分配
+constexpr int keywordIndex(std::string_view text) {
+    if (text.size() < 2 || text.size() > KEYWORD_MAX_LENGTH) return -1;
+    if (text[0] < 'a' || text[0] > 'z') return -1;
+    const int len = static_cast<int>(text.size());
+    const int c = text[0] - 'a';
+    const int end = KEYWORD_BUCKETS.begin[len][c] + KEYWORD_BUCKETS.count[len][c];
+    for (int i = KEYWORD_BUCKETS.begin[len][c]; i < end; ++i) {
+        const int index = KEYWORD_BUCKETS.order[i];
+        if (KEYWORDS[index] == text) return index;
+    }
+    return -1;
+}
+
+constexpr bool keywordTableIsValid() {
+    for (int i = 0; i < KEYWORD_COUNT; ++i) {
+        if (KEYWORDS[i].size() < 2 || KEYWORDS[i].size() > KEYWORD_MAX_LENGTH) return false;
+        if (keywordIndex(KEYWORDS[i]) != i) return false; // 同时检查表中无重复
+    }
+    return true;
+}
+static_assert(keywordTableIsValid(), "关键字须为2~8个小写字母且不重复");
+
+#endif // KEYWORDS_H
@@ -1,16 +1,26 @@
 // lexer.cpp
 #include "lexer.h"
+#include "charscan.h"
+#include "error.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 //#include <cctype>
-#include <iostream>
-#include <unordered_map>
-#include <QDebug>
-Lexer::Lexer(const std::string& source) : source(source),position(0),line(1),column(1) {
+Lexer::Lexer(CompilationContext& context, std::string text) : Lexer(context, SourceBuffer(std::move(text))) {
+}
+
+Lexer::Lexer(CompilationContext& context, SourceBuffer input)
+    : buffer(std::move(input)), source(buffer.view()), position(0), compilation(context) {
     //tokens = scanTokens();//初始化时扫描token
-    startLine = 1;
-    startColumn = 1;
     source_length = source.length();
 }
 
+Lexer::Lexer(CompilationContext& context, std::string_view text, int begin)
+    : source(text), position(begin), source_length(text.length()), chunkScan(true), compilation(context) {
+}
+
 /*void Lexer::scanAllTokens() {
 
     while (!isAtEnd()) {
@@ -26,32 +36,12 @@ bool Lexer::isAtEnd() const {
 
 char Lexer::advance() {
     if (isAtEnd()) return '\0';
-    char c = source[position];
-    position++;
-    // 更新行列位置
-    if (c == '\n') {
-        line++;
-        column = 1;
-    } else {
-        column++;
-    }
-
-
-    //qDebug() << "Advance: '" << c << "' (line: " << line << ", column: " << column << ")\n";
-    return c;
+    return source[position++];
 }
 
 void Lexer::ratreat() {
     if (position == 0) return;
     position--;
-    char c = source[position];
-    if (c == '\n') {
-        line--;
-        // 需重新计算当前行长度才能准确恢复 column，简化处理可直接置 0
-        column = 1;
-    } else {
-        column--;
-    }
 }
 
 char Lexer::peek() const {
@@ -72,26 +62,31 @@ bool Lexer::match(char expected) {
     return true;
 }
 
+// 批量前进到 target
+void Lexer::advanceTo(size_t target) {
+    position = static_cast<int>(target);
+}
+
 // 跳过空白字符和注释
+// 连续的空格/制表符、行注释内容和块注释内容按16/32字节块扫描（见 charscan.h）
 void Lexer::skipWhitespace() {
+    const char* text = source.data();
     while (true) {
         char c = peek();
         switch (c) {
         case ' ':
         case '\t':
         case '\r':
-            advance();
+            advanceTo(charscan::skipBlanks(text, position, source_length));
             break;
         case '\n':
-            //line++;
-            //column = 1;
             advance();
             break;
         case '/':
             if (peekNext() == '/') {
-                // 单行注释
-                while (peek() != '\n' &&peek()!='\r' && !isAtEnd()) advance();
-                // 新增：跳过注释后的换行符，由advance()统一处理行号
+                // 单行注释：直接定位到行尾
+                advanceTo(charscan::findEither(text, position, source_length, '\n', '\r'));
+                // 跳过注释后的换行符
                 if (peek() == '\r') {
                     advance(); // 跳过\r
                     if (peek() == '\n') {
@@ -105,8 +100,11 @@ void Lexer::skipWhitespace() {
                 advance(); // 消费第一个/
                 advance(); // 消费*
 
-                while (!(peek() == '*' && peekNext() == '/') && !isAtEnd()) {
-                    //if (peek() == '\n') line++;
+                // 只在'*'处停下检查是否为结束符
+                while (!isAtEnd()) {
+                    advanceTo(charscan::find(text, position, source_length, '*'));
+                    if (isAtEnd()) break;
+                    if (peekNext() == '/') break;
                     advance();
                 }
 
@@ -125,16 +123,16 @@ void Lexer::skipWhitespace() {
 }
 
 // 扫描所有Token
-std::vector<Token> Lexer::scanTokens() {
-
-
+const std::vector<Token>& Lexer::scanTokens() {
+    if (streaming) {
+        throw std::logic_error("按需扫描模式下不能生成完整Token数组");
+    }
     if (tokensGenerated) {
         // 已生成过，重置tokenIndex后返回现有tokens
         tokenIndex = 0;
-        return this->tokens;
+        return tokens;
     }
-    // 首次生成tokens
-    std::vector<Token> tokens;
+    // 首次生成tokens：直接写入成员，避免局部数组再整体复制一次
     tokens.clear();
     tokenIndex = 0;
     while (!isAtEnd()) {
@@ -142,20 +140,334 @@ std::vector<Token> Lexer::scanTokens() {
         tokens.push_back(scanToken());
     }
 
-    tokens.push_back({TokenType::EOF_TOKEN, "", line, column});
+    tokens.push_back(endToken());
     tokensGenerated = true;  // 标记为已生成
-    this->tokens =tokens;
     return tokens;
 }
 
+namespace {
+
+const char* const UNRECOGNIZED_CHARACTER = "无法识别的字符";
+const char* const UNTERMINATED_STRING = "字符串缺少闭合的'\"'";
+
+// 每块至少 1 MB：块再小时，建立分块和合并结果的开销就抵消了并行的收益
+constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// 并行扫描前的预扫描：按与 Lexer 相同的规则跳过字符串字面量（含转义）、行注释和块注释，
+// 只在 '/' 和 '"' 处停下。每个目标位置之后第一个位于普通代码中的换行，其下一字节
+// 即为分块边界——顺序扫描到那里时必然正处于两个 Token 之间。返回的边界以 0 开头
+std::vector<size_t> findChunkBoundaries(std::string_view source, size_t chunkCount) {
+    const char* text = source.data();
+    size_t length = source.size();
+    size_t chunkSize = length / chunkCount;
+    std::vector<size_t> bounds{0};
+    size_t target = chunkSize;
+
+    // [from, to) 是普通代码，在其中找目标位置之后的换行
+    auto takeBoundaries = [&](size_t from, size_t to) {
+        while (bounds.size() < chunkCount && target < to) {
+            size_t newline = charscan::find(text, std::max(from, target), to, '\n');
+            if (newline >= to) {
+                target = to;    // [target, to) 中没有换行，下次从 to 开始找
+                return;
+            }
+            if (newline + 1 >= length) return;
+            bounds.push_back(newline + 1);
+            target = std::max(bounds.size() * chunkSize, newline + 1);
+        }
+    };
+
+    size_t normalFrom = 0;
+    size_t pos = 0;
+    while (pos < length && bounds.size() < chunkCount) {
+        pos = charscan::findEither(text, pos, length, '"', '/');
+        takeBoundaries(normalFrom, pos);
+        if (pos >= length) break;
+        if (text[pos] == '"') {
+            ++pos;
+            while (pos < length) {
+                pos = charscan::findEither(text, pos, length, '"', '\\');
+                if (pos >= length || text[pos] == '"') break;
+                pos += 2;   // 反斜杠及其转义的字符
+            }
+            pos = std::min(pos + 1, length);
+        } else if (pos + 1 < length && text[pos + 1] == '/') {
+            // 行注释：结束处的换行本身属于普通代码
+            pos = charscan::findEither(text, pos + 2, length, '\n', '\r');
+        } else if (pos + 1 < length && text[pos + 1] == '*') {
+            pos += 2;
+            while (true) {
+                pos = charscan::find(text, pos, length, '*');
+                if (pos >= length) break;
+                if (pos + 1 < length && text[pos + 1] == '/') {
+                    pos += 2;
+                    break;
+                }
+                ++pos;
+            }
+        } else {
+            ++pos;      // 除号，仍在普通代码中
+            continue;
+        }
+        normalFrom = pos;
+    }
+    return bounds;
+}
+
+} // namespace
+
+const std::vector<Token>& Lexer::scanTokens(ThreadPool& pool) {
+    if (streaming || tokensGenerated) {
+        return scanTokens();
+    }
+    // 每个线程分几块，扫描快慢不一时空闲线程可以窃取剩下的块。只有一个线程时分块只会
+    // 多出合并的开销，直接顺序扫描
+    size_t chunkCount = std::min<size_t>(source_length / MIN_CHUNK_BYTES, pool.size() * 4);
+    std::vector<size_t> bounds;
+    if (pool.size() >= 2 && chunkCount >= 2) {
+        bounds = findChunkBoundaries(source, chunkCount);
+    }
+    if (bounds.size() < 2) {
+        return scanTokens();
+    }
+    bounds.push_back(source_length);
+
+    // 每块用独立的 context（驻留表与错误列表），互不加锁
+    struct Chunk {
+        std::unique_ptr<CompilationContext> context;
+        std::unique_ptr<Lexer> lexer;
+        std::vector<int> remap;     // 块内标识符编号 -> 本扫描器的编号
+        size_t first = 0;           // 在合并结果中的起始下标
+    };
+    size_t count = bounds.size() - 1;
+    std::vector<Chunk> chunks(count);
+    for (size_t i = 0; i < count; ++i) {
+        pool.submit([this, &chunks, &bounds, i, count] {
+            Chunk& chunk = chunks[i];
+            chunk.context = std::make_unique<CompilationContext>();
+            chunk.lexer.reset(new Lexer(*chunk.context, source.substr(0, bounds[i + 1]),
+                                        static_cast<int>(bounds[i])));
+            chunk.lexer->scanChunk(i + 1 == count);
+        });
+    }
+    pool.wait();
+
+    // 按块的顺序把各块的新名字驻留到本扫描器的驻留表：名字按首次出现的顺序登记，
+    // 编号与顺序扫描时一致。错误同样按块的顺序登记，行列号在完整源码上计算
+    StringInterner& names = compilation.names();
+    size_t total = 0;
+    for (Chunk& chunk : chunks) {
+        const StringInterner& local = chunk.context->names();
+        chunk.remap.resize(local.size());
+        for (int id = 0; id < local.size(); ++id) {
+            chunk.remap[id] = names.intern(local.str(id));
+        }
+        for (const Error& error : chunk.context->errors().takeErrors()) {
+            SourceLocation loc = location(error.offset);
+            compilation.errors().addError(error.type, loc.line, loc.column, error.offset, error.length,
+                                          error.message);
+        }
+        // 含转义的字符串解码结果移交给本扫描器，Token 中的视图保持有效
+        decodedStrings.splice(decodedStrings.end(), chunk.lexer->decodedStrings);
+        chunk.first = total;
+        total += chunk.lexer->tokens.size();
+    }
+
+    // 各块的Token并行换算编号并写入各自的位置
+    tokens.clear();
+    tokens.resize(total);
+    for (size_t i = 0; i < count; ++i) {
+        pool.submit([this, &chunks, i] {
+            Chunk& chunk = chunks[i];
+            Token* out = tokens.data() + chunk.first;
+            for (Token token : chunk.lexer->tokens) {
+                if (token.type == TokenType::IDENTIFIER) {
+                    token.id = chunk.remap[token.id];
+                }
+                *out++ = token;
+            }
+            chunk.lexer.reset();
+            chunk.context.reset();
+        });
+    }
+    pool.wait();
+
+    tokens.push_back(endToken());
+    tokenIndex = 0;
+    tokensGenerated = true;
+    return tokens;
+}
+
+// 扫描一个分块的Token，不含结束标记
+void Lexer::scanChunk(bool last) {
+    while (!isAtEnd()) {
+        start = position;
+        Token token = scanToken();
+        // 块尾的换行之后没有Token：顺序扫描时这段空白会被下一块的第一个Token跳过，不产生标记
+        if (!last && token.offset == static_cast<int>(source_length)) break;
+        tokens.push_back(token);
+    }
+}
+
+TokenEdit Lexer::applyEdit(int offset, int removedLength, std::string_view text) {
+    if (streaming) {
+        throw std::logic_error("按需扫描模式下不能增量扫描");
+    }
+    if (offset < 0 || removedLength < 0 || static_cast<size_t>(offset) + removedLength > source_length) {
+        throw std::out_of_range("编辑范围超出源码");
+    }
+    int delta = static_cast<int>(text.size()) - removedLength;
+    const char* oldData = source.data();
+    buffer.replace(offset, removedLength, text);
+    source = buffer.view();
+    source_length = source.length();
+    lineStarts.clear();
+    tokenIndex = 0;
+    if (!tokensGenerated) {
+        return {};
+    }
+
+    // 扫描一个Token最多向后多看两个字符（数字后的 '.' 及其后的数字），结束处与编辑位置
+    // 至少相隔这么远的Token不受影响；从最后一个这样的Token之后开始重新扫描
+    constexpr int SCAN_LOOKAHEAD = 2;
+    auto affected = std::partition_point(tokens.begin(), tokens.end(), [offset](const Token& token) {
+        return token.offset + token.length + SCAN_LOOKAHEAD <= offset;
+    });
+    size_t first = affected - tokens.begin();
+    position = first > 0 ? tokens[first - 1].offset + tokens[first - 1].length : 0;
+
+    // 编辑之后的源码没有变化：新Token的起点若恰好是某个旧Token（平移 delta 后）的起点，
+    // 从那里开始的扫描结果必然与原来相同，后面的旧Token原样保留。旧的结束标记不参与对齐，
+    // 否则源码末尾新出现的空白产生的结束Token会被它吞掉
+    int editEnd = offset + static_cast<int>(text.size());
+    auto oldEnd = tokens.end() - 1;
+    size_t resync = tokens.size();
+    std::vector<Token> scanned;
+    recordErrors = false;
+    while (!isAtEnd()) {
+        start = position;
+        Token token = scanToken();
+        if (token.offset >= editEnd) {
+            int oldOffset = token.offset - delta;
+            auto match = std::lower_bound(tokens.begin() + first, oldEnd, oldOffset,
+                                          [](const Token& old, int value) { return old.offset < value; });
+            if (match != oldEnd && match->offset == oldOffset) {
+                resync = match - tokens.begin();
+                break;
+            }
+        }
+        scanned.push_back(token);
+    }
+    recordErrors = true;
+    if (resync == tokens.size()) {
+        scanned.push_back(endToken());
+    }
+    position = static_cast<int>(source_length);
+
+    // 直接引用源码的Token值改指向新的源码：编辑之后的部分移动了 delta，源码扩容换了存储时
+    // 前面的部分也要改。字面量和解码结果不变
+    auto rebase = [this](Token& token) {
+        if (valueInSource(token)) {
+            token.value = source.substr(valueOffset(token), token.value.size());
+        }
+    };
+    if (source.data() != oldData) {
+        for (size_t i = 0; i < first; ++i) {
+            rebase(tokens[i]);
+        }
+    }
+    for (size_t i = resync; i < tokens.size(); ++i) {
+        tokens[i].offset += delta;
+        rebase(tokens[i]);
+    }
+
+    // 覆盖两者重叠的部分，多出或少掉的部分再插入或删除，后面的Token只移动一次
+    size_t removed = resync - first;
+    size_t common = std::min(removed, scanned.size());
+    std::copy(scanned.begin(), scanned.begin() + common, tokens.begin() + first);
+    if (scanned.size() > removed) {
+        tokens.insert(tokens.begin() + first + common, scanned.begin() + common, scanned.end());
+    } else {
+        tokens.erase(tokens.begin() + first + common, tokens.begin() + resync);
+    }
+    return {static_cast<int>(first), static_cast<int>(removed), static_cast<int>(scanned.size())};
+}
+
+TokenEdit Lexer::updateText(std::string_view text) {
+    size_t limit = std::min(source_length, text.size());
+    size_t prefix = std::mismatch(source.begin(), source.begin() + limit, text.begin()).first - source.begin();
+    size_t suffix = 0;
+    while (suffix < limit - prefix && source[source_length - 1 - suffix] == text[text.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    if (prefix == limit && source_length == text.size()) {
+        return {};
+    }
+    return applyEdit(static_cast<int>(prefix), static_cast<int>(source_length - prefix - suffix),
+                     text.substr(prefix, text.size() - prefix - suffix));
+}
+
+// 出错的字符和未闭合的字符串都产生 ERROR_TOKEN，后者以引号开头
+void Lexer::reportLexicalErrors() {
+    for (const Token& token : tokens) {
+        if (token.type != TokenType::ERROR_TOKEN) continue;
+        if (source[token.offset] == '"') {
+            lexicalError(token.offset, 1, UNTERMINATED_STRING);
+        } else {
+            lexicalError(token.offset, token.length, UNRECOGNIZED_CHARACTER);
+        }
+    }
+}
+
+void Lexer::enableStreaming() {
+    if (tokensGenerated) {
+        throw std::logic_error("已生成完整Token数组，不能再切换到按需扫描模式");
+    }
+    streaming = true;
+}
+
+// 按需扫描下一个Token，产生的序列与 scanTokens() 完全一致（包括最后的结束标记）
+Token Lexer::scanStreamToken() {
+    ++streamedCount;
+    if (!isAtEnd()) {
+        start = position;
+        return scanToken();
+    }
+    streamFinished = true;
+    return endToken();
+}
+
+// 保证环形缓冲区中至少有 n+1 个Token，源码已扫描完时返回false
+bool Lexer::fillLookahead(int n) {
+    while (lookaheadCount <= n && !streamFinished) {
+        lookahead[(lookaheadHead + lookaheadCount) % LOOKAHEAD_CAPACITY] = scanStreamToken();
+        ++lookaheadCount;
+    }
+    return lookaheadCount > n;
+}
+
+Token Lexer::nextStreamToken() {
+    if (!fillLookahead(0)) return endToken();
+    Token token = lookahead[lookaheadHead];
+    lookaheadHead = (lookaheadHead + 1) % LOOKAHEAD_CAPACITY;
+    --lookaheadCount;
+    return token;
+}
+
+Token Lexer::peekStreamToken(int offset) {
+    if (offset >= LOOKAHEAD_CAPACITY) {
+        throw std::out_of_range("按需扫描模式的前看距离超出缓冲区容量");
+    }
+    if (!fillLookahead(offset)) return endToken();
+    return lookahead[(lookaheadHead + offset) % LOOKAHEAD_CAPACITY];
+}
+
 // 扫描单个Token
 Token Lexer::scanToken() {
     //int currentColumn = column; // 保存当前列号
     skipWhitespace();
     start = position;
-    startLine = line;
-    startColumn = column;
-    if (isAtEnd()) return {TokenType::EOF_TOKEN, "", startLine, startColumn};
+    if (isAtEnd()) return makeToken(TokenType::EOF_TOKEN, "");
 
     char c = advance();
 
@@ -170,128 +482,156 @@ Token Lexer::scanToken() {
     case '&':
         if (peek() == '&') {
             advance();
-            return {TokenType::OPERATOR, "&&", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "&&");
         } else {
-            return {TokenType::OPERATOR, "&", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "&");
         }
     case '|':
         if (peek() == '|') {
             advance();
-            return {TokenType::OPERATOR, "||", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "||");
         } else {
-            return {TokenType::OPERATOR, "|", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "|");
         }
 
-    case ';': return {TokenType::PUNCTUATOR, ";", startLine, startColumn};
+    case ';': return makeToken(TokenType::PUNCTUATOR, ";");
     case '+':
         if (peek() == '+') {
             advance();
-            return {TokenType::OPERATOR, "++", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "++");
         } else if (peek() == '=') {
             advance();
-            return {TokenType::OPERATOR, "+=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "+=");
         } else {
-            return {TokenType::OPERATOR, "+", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "+");
         }
     case '-':
         if (peek() == '-') {
             advance();
-            return {TokenType::OPERATOR, "--", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "--");
         } else if (peek() == '=') {
             advance();
-            return {TokenType::OPERATOR, "-=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "-=");
         } else {
-            return {TokenType::OPERATOR, "-", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "-");
         }
-        //case '+': return {TokenType::OPERATOR, "+", startLine, startColumn};
-    //case '-': return {TokenType::OPERATOR, "-", startLine, startColumn};
+        //case '+': return makeToken(TokenType::OPERATOR, "+");
+    //case '-': return makeToken(TokenType::OPERATOR, "-");
     case '*':
         if (peek() == '=') {
             advance();
-            return {TokenType::OPERATOR, "*=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "*=");
         } else {
-            return {TokenType::OPERATOR, "*", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "*");
         }
     case '/':
         if (peek() == '=') {
             advance();
-            return {TokenType::OPERATOR, "/=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "/=");
         } else {
-            return {TokenType::OPERATOR, "/", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "/");
         }
-    //case '*': return {TokenType::OPERATOR, "*", startLine, startColumn};
-    //case '/': return {TokenType::OPERATOR, "/", startLine, startColumn};
-    //case '=': return {TokenType::OPERATOR, "=", startLine, startColumn};
-    case ',': return {TokenType::PUNCTUATOR, ",", startLine, startColumn};
-    case ':': return {TokenType::PUNCTUATOR, ":", startLine, startColumn};
-    case '(': return {TokenType::PUNCTUATOR, "(", startLine, startColumn};
-    case ')': return {TokenType::PUNCTUATOR, ")", startLine, startColumn};
-    case '{': return {TokenType::PUNCTUATOR, "{", startLine, startColumn};
-    case '}': return {TokenType::PUNCTUATOR, "}", startLine, startColumn};
+    //case '*': return makeToken(TokenType::OPERATOR, "*");
+    //case '/': return makeToken(TokenType::OPERATOR, "/");
+    //case '=': return makeToken(TokenType::OPERATOR, "=");
+    case ',': return makeToken(TokenType::PUNCTUATOR, ",");
+    case ':': return makeToken(TokenType::PUNCTUATOR, ":");
+    case '(': return makeToken(TokenType::PUNCTUATOR, "(");
+    case ')': return makeToken(TokenType::PUNCTUATOR, ")");
+    case '{': return makeToken(TokenType::PUNCTUATOR, "{");
+    case '}': return makeToken(TokenType::PUNCTUATOR, "}");
     case '"': return string();
-    //case '>': return {TokenType::OPERATOR, ">", startLine, startColumn};
-    //case '<': return {TokenType::OPERATOR, "<", startLine, startColumn};
+    //case '>': return makeToken(TokenType::OPERATOR, ">");
+    //case '<': return makeToken(TokenType::OPERATOR, "<");
     case '=':
         if (peek() == '=') {  // 处理"=="
             advance();
-            return {TokenType::OPERATOR, "==", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "==");
         } else {
-            return {TokenType::OPERATOR, "=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "=");
         }
     case '<':
         if (peek() == '<') {
             advance();
-            return {TokenType::OPERATOR, "<<", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "<<");
         }else if (peek() == '=') {  // 处理"<="
             advance();
-            return {TokenType::OPERATOR, "<=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "<=");
         } else {
-            return {TokenType::OPERATOR, "<", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "<");
         }
     case '>':
         if (peek() == '>') {
             advance();
-            return {TokenType::OPERATOR, ">>", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, ">>");
         } else if (peek() == '=') {  // 处理">="
             advance();
 
-            return {TokenType::OPERATOR, ">=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, ">=");
         } else {
 
-            return {TokenType::OPERATOR, ">", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, ">");
         }
     case '!':
         if (peek() == '=') {  // 处理"!="
             advance();
-            return {TokenType::OPERATOR, "!=", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "!=");
         } else {
-            return {TokenType::OPERATOR, "!", startLine, startColumn};
+            return makeToken(TokenType::OPERATOR, "!");
         }
 
 
-    //case '==': return {TokenType::OPERATOR, "==", startLine, startColumn};
-    //case '>=': return {TokenType::OPERATOR, ">=", startLine, startColumn};
-    //case '<=': return {TokenType::OPERATOR, "<=", startLine, startColumn};
+    //case '==': return makeToken(TokenType::OPERATOR, "==");
+    //case '>=': return makeToken(TokenType::OPERATOR, ">=");
+    //case '<=': return makeToken(TokenType::OPERATOR, "<=");
     }
 
     // 错误处理
-    std::cerr << "Unexpected character at startLine " << startLine << ", column " << startColumn << std::endl;
-    return {TokenType::EOF_TOKEN, "", startLine, startColumn};
+    lexicalError(start, position - start, UNRECOGNIZED_CHARACTER);
+    return makeToken(TokenType::ERROR_TOKEN, "");
+}
+
+std::string_view Lexer::lexeme() const {
+    return std::string_view(source.data() + start, position - start);
+}
+
+Token Lexer::makeToken(TokenType type, std::string_view value, int id) const {
+    return {type, value, start, position - start, id};
+}
+
+void Lexer::lexicalError(int offset, int length, const char* message) {
+    if (!recordErrors) return;
+    SourceLocation loc = chunkScan ? SourceLocation{0, 0} : location(offset);
+    compilation.errors().addError(ErrorType::LEXICAL_ERROR, loc.line, loc.column, offset, length, message);
+}
+
+SourceLocation Lexer::location(int offset) const {
+    if (lineStarts.empty()) {
+        lineStarts.push_back(0);
+        const char* text = source.data();
+        for (size_t pos = 0; pos < source_length; ++pos) {
+            pos = charscan::find(text, pos, source_length, '\n');
+            if (pos < source_length) lineStarts.push_back(static_cast<int>(pos + 1));
+        }
+    }
+    // 最后一个不大于 offset 的行首即所在行
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    int line = static_cast<int>(it - lineStarts.begin());
+    return {line, offset - lineStarts[line - 1] + 1};
 }
 
 // 处理标识符和关键字
 Token Lexer::identifier() {
     while (isAlphaNumeric(peek())) advance();
 
-    std::string text = source.substr(start, position - start);
+    std::string_view text = lexeme();
 
-    // 检查是否为关键字
-
-    if (keywords.find(text) != keywords.end()) {
-        return {keywords[text], text, startLine, startColumn};
+    // 检查是否为关键字（关键字的驻留编号与其下标一致，无需查表）
+    int keyword = keywordIndex(text);
+    if (keyword >= 0) {
+        return makeToken(TokenType::KEYWORD, text, keyword);
     }
-
-    return {TokenType::IDENTIFIER, text, startLine, startColumn};
+    return makeToken(TokenType::IDENTIFIER, text, compilation.names().intern(text));
 }
 
 // 处理数字
@@ -304,39 +644,50 @@ Token Lexer::number() {
         while (isDigit(peek())) advance();
     }
 
-    std::string value = source.substr(start, position - start);
-    return {TokenType::NUMBER, value, startLine, startColumn};
+    return makeToken(TokenType::NUMBER, lexeme());
 }
 
 // 处理字符串
 Token Lexer::string() {
-    std::string value;
+    bool hasEscape = false;
     while (peek() != '"' && !isAtEnd()) {
-        if (peek() == '\n') {line++;column=1;}
         if (peek() == '\\') {
-            // 处理转义字符
+            hasEscape = true;
             advance(); // 跳过'\'
-            switch(peek()) {
-            case '"': value += '"'; advance(); break; // 转义引号
-            case '\\': value += '\\'; advance(); break; // 转义反斜杠
-            case 'n': value += '\n'; advance(); break; // 换行符
-            case 't': value += '\t'; advance(); break; // 制表符
-            default: value += peek(); advance(); break; // 其他转义保留原样
-            }
-        } else {
-            value += peek();
-            advance();
         }
+        advance();
     }
 
     if (isAtEnd()) {
-        std::cerr << "Unterminated string at line " << startLine << std::endl;
-        return {TokenType::EOF_TOKEN, "", startLine, startColumn};
+        lexicalError(start, 1, UNTERMINATED_STRING);
+        return makeToken(TokenType::ERROR_TOKEN, "");
     }
 
     advance(); // 消费闭合引号
 
-    return {TokenType::STRING, value, startLine, startColumn};
+    // 去掉引号后的原始内容；没有转义时直接引用源码，不分配内存
+    std::string_view raw(source.data() + start + 1, position - start - 2);
+    if (!hasEscape) {
+        return makeToken(TokenType::STRING, raw);
+    }
+
+    // 处理转义字符，结果保存在 decodedStrings 中
+    std::string& value = decodedStrings.emplace_back();
+    value.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        if (raw[i] != '\\' || i + 1 >= raw.size()) {
+            value += raw[i];
+            continue;
+        }
+        switch (raw[++i]) {
+        case '"': value += '"'; break; // 转义引号
+        case '\\': value += '\\'; break; // 转义反斜杠
+        case 'n': value += '\n'; break; // 换行符
+        case 't': value += '\t'; break; // 制表符
+        default: value += raw[i]; break; // 其他转义保留原样
+        }
+    }
+    return makeToken(TokenType::STRING, value);
     // 提取字符串内容（去掉引号）
     //std::string value = source.substr(start + 1, position - start - 2);
     //return {TokenType::STRING, value, startLine, startColumn};
@@ -344,19 +695,20 @@ Token Lexer::string() {
 
 // 判断字符类型
 bool Lexer::isAlpha(char c) const {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    return charscan::isAlpha(c);
 }
 
 bool Lexer::isDigit(char c) const {
-    return c >= '0' && c <= '9';
+    return charscan::isDigit(c);
 }
 
 bool Lexer::isAlphaNumeric(char c) const {
-    return isAlpha(c) || isDigit(c);
+    return charscan::isAlphaNumeric(c);
 }
 
 //接口
-bool Lexer::hasNext() {
+bool Lexer::hasNext() const {
+    if (streaming) return lookaheadCount > 0 || !streamFinished;
     return tokenIndex < tokens.size();
 }
 
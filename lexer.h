@@ -4,18 +4,32 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <list>
+#include <memory>
 #include "token.h"
-#include <unordered_map>
+#include "interner.h"
+#include "keywords.h"
+#include "sourcebuffer.h"
+#include "compilation.h"
+
+class ThreadPool;
+
+// 一次增量扫描替换的Token范围：编辑前的 [first, first + removed) 换成了现在的 [first, first + inserted)
+struct TokenEdit {
+    int first = 0;
+    int removed = 0;
+    int inserted = 0;
+};
+
 class Lexer {
 private:
-    std::string source;     // 源代码
+    SourceBuffer buffer;    // 源代码存储（字符串或文件映射）
+    std::string_view source;    // 源代码，指向 buffer
     int position = 0;       // 当前字符位置
     int start = 0;          // 当前Token起始位置
-    int line = 1;           // 当前行号
-    int column = 1;         // 当前列号
-    int startLine;   // Token起始行
-    int startColumn; // Token起始列
     size_t source_length;
+    mutable std::vector<int> lineStarts;    // 每行首字节偏移，首次查询位置时构建
 
     // 辅助方法
     void ratreat();         // 回退一个字符
@@ -23,6 +37,7 @@ private:
     char peek() const;      // 查看当前字符（不移动位置）
     char peekNext() const;  // 查看下一个字符（不移动位置）
     bool match(char expected); // 匹配并消费指定字符
+    void advanceTo(size_t target); // 批量前进到指定位置
     void skipWhitespace();  // 跳过空白字符和注释
     void skipComment();     // 跳过注释（单行和多行）
     bool tokensGenerated = false;  // 标记是否已生成tokens
@@ -36,89 +51,108 @@ private:
     bool isAlpha(char c) const;
     bool isDigit(char c) const;
     bool isAlphaNumeric(char c) const;
+    std::string_view lexeme() const;   // 当前Token在源码中的文本
+    Token makeToken(TokenType type, std::string_view value, int id = -1) const;
+    void lexicalError(int offset, int length, const char* message);
+    bool recordErrors = true;   // 增量扫描时不登记错误，由 reportLexicalErrors() 统一登记
+
+    // 并行扫描的分块：在主扫描器的源码上扫描 [begin, text.size())，Token 偏移即为全文偏移，
+    // 标识符编号属于分块自己的 context，由主扫描器合并时换算
+    Lexer(CompilationContext& context, std::string_view text, int begin);
+    void scanChunk(bool last);
+    bool chunkScan = false;     // 分块扫描器：源码视图不完整，错误的行列号留给主扫描器计算
+
+    CompilationContext& compilation;  // 本翻译单元的驻留表（关键字编号即其在 KEYWORDS 中的下标）与错误列表
+    std::list<std::string> decodedStrings;   // 含转义的字符串字面量解码结果（地址稳定）
 
     //新增接口
     std::vector<Token> tokens;  // 缓存所有 Token
     int tokenIndex = 0;         // 当前 Token 索引
     //void scanAllTokens();       // 一次性扫描所有 Token（内部调用）
 
-    // 定义关键字集合
-    static std::unordered_map<std::string, TokenType> keywords;
+    // 按需扫描模式：只保留解析器前看所需的少量Token（当前Token之后最多再看2个，
+    // 即 peekAheadToken(1)），内存占用与源码大小无关
+    static constexpr int LOOKAHEAD_CAPACITY = 4;
+    bool streaming = false;
+    bool streamFinished = false;    // 已产出最后的结束标记
+    Token lookahead[LOOKAHEAD_CAPACITY];
+    int lookaheadHead = 0;
+    int lookaheadCount = 0;
+    size_t streamedCount = 0;       // 按需模式下已产出的Token数
+    Token scanStreamToken();
+    bool fillLookahead(int n);
+    Token nextStreamToken();
+    Token peekStreamToken(int offset);
 public:
-    explicit Lexer(const std::string& source);
-    std::vector<Token> scanTokens();
+    Lexer(CompilationContext& context, std::string text);
+    // 直接在缓冲区上扫描，例如 Lexer(context, SourceBuffer::fromFile(path)) 不会复制文件内容
+    Lexer(CompilationContext& context, SourceBuffer input);
+    // Token 中的视图指向本对象内部，禁止复制
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
+    // 一次性扫描并缓存全部Token（GUI 的Token列表使用此模式）
+    const std::vector<Token>& scanTokens();
+    // 同上，但把大文件在字符串和注释以外的换行处切成若干块，在线程池中并行扫描后按顺序拼接；
+    // Token、标识符编号与错误和 scanTokens() 完全相同。文件较小时直接顺序扫描。
+    // 内部会等待线程池，不能在该线程池的任务中调用
+    const std::vector<Token>& scanTokens(ThreadPool& pool);
+    // 增量扫描：源码 [offset, offset + removedLength) 替换为 text 后，从编辑处之前最后一个不受影响的
+    // Token 之后重新扫描，直到新Token与编辑前的Token流重新对齐，再就地修补Token数组。
+    // 得到的Token序列与对新源码完整扫描相同（新出现的标识符按驻留顺序追加编号）。
+    // 重新扫描中的词法错误不登记，需要完整的错误列表时清空后调用 reportLexicalErrors()。
+    // 仅完整模式；尚未扫描时只替换源码。被替换的字符串字面量的解码结果不回收
+    TokenEdit applyEdit(int offset, int removedLength, std::string_view text);
+    // 与当前源码比较，去掉相同的前缀和后缀，把中间不同的部分作为一次编辑交给 applyEdit()
+    TokenEdit updateText(std::string_view text);
+    // 按当前Token数组重新登记全部词法错误（无法识别的字符、未闭合的字符串）
+    void reportLexicalErrors();
+    std::string_view text() const { return source; }
+    // 切换到按需扫描模式，须在 scanTokens() 之前调用；此后 nextToken()/peek*() 边读边扫描
+    void enableStreaming();
+    bool isStreaming() const { return streaming; }
+    size_t streamedTokenCount() const { return streamedCount; }
 
     bool isAtEnd() const;
-    bool hasNext();        // 是否还有未处理的 Token
-    bool hasNext() const { return tokenIndex < tokens.size(); }
+    bool hasNext() const;  // 是否还有未处理的 Token
     Token nextToken() {//获取下一个Token并推进索引
-        return hasNext() ? tokens[tokenIndex++] : Token{TokenType::EOF_TOKEN, "", 0, 0};
+        if (streaming) return nextStreamToken();
+        return hasNext() ? tokens[tokenIndex++] : endToken();
     }
-    Token peekNextToken() const {//查看下一个Token但不推进索引
-        return (tokenIndex < tokens.size()) ? tokens[tokenIndex]
-                                            : Token{TokenType::EOF_TOKEN, "", 0, 0};
+    Token peekNextToken() {//查看下一个Token但不推进索引
+        return peekAheadToken(0);
     }
 
-    Token peekAheadToken(int offset) const {
+    Token peekAheadToken(int offset) {
+        if (streaming && offset >= 0) return peekStreamToken(offset);
         if (offset < 0 || tokenIndex + offset >= tokens.size()) {
-            return {TokenType::EOF_TOKEN, "", 0, 0};
+            return endToken();
         }
         return tokens[tokenIndex + offset];
     }
 
-    void backupToken() {
+    // 位于源码末尾的结束标记
+    Token endToken() const {
+        return {TokenType::EOF_TOKEN, "", static_cast<int>(source_length), 0};
+    }
+
+    // 由字节偏移计算行列号：首次调用时建立换行偏移表，之后二分查找
+    SourceLocation location(int offset) const;
+    SourceLocation location(const Token& token) const { return location(token.offset); }
+
+    void backupToken() {  // 仅完整模式支持回退
         if (tokenIndex > 0) tokenIndex--;
     }
-    void reset() {  // 重置方法
+    void reset() {  // 重置方法（仅完整模式有效）
         tokenIndex = 0;
         //tokensGenerated = false;
     }
-};
-inline std::unordered_map<std::string, TokenType> Lexer::keywords = {
-    // 控制流关键字
-    {"if", TokenType::KEYWORD},
-    {"else", TokenType::KEYWORD},
-    {"switch", TokenType::KEYWORD},
-    {"case", TokenType::KEYWORD},
-    {"default", TokenType::KEYWORD},
-    {"break", TokenType::KEYWORD},
-    {"continue", TokenType::KEYWORD},
-    {"goto", TokenType::KEYWORD},
-    {"return", TokenType::KEYWORD},
-
-    // 循环关键字
-    {"for", TokenType::KEYWORD},
-    {"while", TokenType::KEYWORD},
-    {"do", TokenType::KEYWORD},
-
-    // 数据类型关键字
-    {"int", TokenType::KEYWORD},
-    {"char", TokenType::KEYWORD},
-    {"float", TokenType::KEYWORD},
-    {"double", TokenType::KEYWORD},
-    {"void", TokenType::KEYWORD},
-    {"short", TokenType::KEYWORD},
-    {"long", TokenType::KEYWORD},
-    {"signed", TokenType::KEYWORD},
-    {"unsigned", TokenType::KEYWORD},
-    {"enum", TokenType::KEYWORD},
-    {"struct", TokenType::KEYWORD},
-    {"union", TokenType::KEYWORD},
-
-    // 存储类关键字
-    {"auto", TokenType::KEYWORD},
-    {"static", TokenType::KEYWORD},
-    {"register", TokenType::KEYWORD},
-    {"extern", TokenType::KEYWORD},
-    {"typedef", TokenType::KEYWORD},
-
-    // 类型修饰符
-    {"const", TokenType::KEYWORD},
-    {"volatile", TokenType::KEYWORD},
-
-    // 运算符关键字
-    {"sizeof", TokenType::KEYWORD}
-};
+    // 完整模式下的Token数组与游标（下一个要返回的Token的下标），供解析器跳过整段Token
+    const std::vector<Token>& tokenArray() const { return tokens; }
+    int tokenPosition() const { return tokenIndex; }
+    void seekToken(int index) { tokenIndex = index; }
 
+    CompilationContext& context() const { return compilation; }
+    const StringInterner& names() const { return compilation.names(); }
+};
 
 #endif // LEXER_H
@@ -1,13 +1,27 @@
 //main.cpp
 #include "mainwindow.h"
+#include "trace.h"
 #include <windows.h>
 #include <QApplication>
 #include <QLocale>
 #include <QTranslator>
+#include <QDebug>
+#include <cstdlib>
+
+// 调试跟踪转到 Qt 的日志输出（IDE 的应用程序输出窗口可见）
+static void traceToQtLog(unsigned, trace::Level, const std::string &message)
+{
+    qDebug().noquote() << QString::fromStdString(message);
+}
 
 int main(int argc, char *argv[])
 {
     SetConsoleOutputCP(65001);
+    // 环境变量 COMPILER_TRACE 按需开启调试跟踪，格式同命令行工具的 --trace，如 parser,gui:verbose
+    if (const char *spec = std::getenv("COMPILER_TRACE")) {
+        trace::setSink(traceToQtLog);
+        trace::configure(spec);
+    }
     QApplication a(argc, argv);
 
     QTranslator translator;
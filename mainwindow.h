@@ -3,8 +3,17 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include "lexer.h"
+#include <QFutureWatcher>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include "compilesession.h"
+#include "error.h"
 #include <QListWidgetItem>
+class QCheckBox;
+class QComboBox;
+class TokenListModel;
+class AstTreeModel;
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
@@ -25,12 +34,27 @@ private slots:  // 槽函数部分
     void compileButtonClicked();  // 声明槽函数
     void clearButtonClicked(); //清空函数
     void errorListItemClicked(QListWidgetItem *item);//错误列表
+    void compileFinished();     // 后台编译结束（GUI 线程）
+    void editorTextChanged();   // 自动编译模式下重新开始计时
 private:
     Ui::MainWindow *ui;
-    void displayTokens(const std::vector<Token>& tokens);
+    void startCompile();
+    void showSnapshot(const std::shared_ptr<const CompileSnapshot>& snapshot);
     void highlightErrorLine(int line);
     QMap<QListWidgetItem*, int> errorLineMap; // 错误项到行号的映射
     void showError(const QString &errorMsg, int lineNumber,int columnNumber);
+    void showErrors(const std::vector<Error> &errors); // 显示一次编译收集到的全部错误
     int currentFontSize; // 当前字体大小
+    // 后台编译：同一时刻至多一个编译任务，session 只由该任务使用
+    std::unique_ptr<CompileSession> session;
+    QFutureWatcher<std::shared_ptr<const CompileSnapshot>> compileWatcher;
+    std::shared_ptr<std::atomic<bool>> compileCancel;   // 最近一次编译任务的取消标记
+    bool recompileRequested = false;    // 任务结束后以编辑器当前内容再编译一次
+    std::shared_ptr<const CompileSnapshot> currentSnapshot;    // 正在显示的结果
+    QCheckBox *autoCompileBox;
+    TokenListModel *tokenModel;
+    AstTreeModel *astModel;
+    QComboBox *tokenFilterBox;  // 按类型过滤Token列表
+    QTimer autoCompileTimer;            // 停止输入一段时间后才自动编译
 };
 #endif // MAINWINDOW_H
@@ -3,10 +3,19 @@
 #include "token.h"
 #include "ast.h"
 #include "error.h"
+#include <algorithm>
+#include <deque>
 #include <iostream>
-#include <stdexcept> // 用于抛出解析错误
 #include <unordered_map>
-#include <QDebug>
+#include "threadpool.h"
+#include "trace.h"
+
+namespace {
+// 类型关键字的驻留表编号（关键字编号即其在 KEYWORDS 中的下标）
+constexpr int TYPE_INT = keywordIndex("int");
+constexpr int TYPE_FLOAT = keywordIndex("float");
+} // namespace
+
 std::string tokenTypeToString(TokenType type)
 {
     switch (type)
@@ -23,6 +32,8 @@ std::string tokenTypeToString(TokenType type)
         return "PUNCTUATOR";
     case TokenType::STRING:
         return "STRING";
+    case TokenType::ERROR_TOKEN:
+        return "ERROR_TOKEN";
     case TokenType::EOF_TOKEN:
         return "EOF_TOKEN";
     // ... 其他 TokenType 值
@@ -32,7 +43,7 @@ std::string tokenTypeToString(TokenType type)
 }
 
 // 运算符优先级表（值越大优先级越高，与文法中的Expr1~Expr4对应）
-const std::unordered_map<std::string, int> OP_PRECEDENCE = {
+const std::unordered_map<std::string_view, int> OP_PRECEDENCE = {
     {"**", 40},
     {"!",40},
     {"*", 30},
@@ -51,38 +62,153 @@ const std::unordered_map<std::string, int> OP_PRECEDENCE = {
     {"||", 3},
 };
 
-Parser::Parser(Lexer &lexer) : lexer(lexer)
+Parser::Parser(Lexer &lexer)
+    : lexer(lexer), context(lexer.context()), errors(context.errors()), symTable(context.symbols()),
+      arena(context.arena())
 {
     // nextToken();  // 初始化：读取第一个Token
-    //  确保Lexer已准备好
-    lexer.scanTokens(); // 确保Token已生成
-    lexer.reset();      // 重置索引
+    //  确保Lexer已准备好；按需扫描模式下由 nextToken() 边解析边扫描
+    if (!lexer.isStreaming())
+    {
+        lexer.scanTokens(); // 确保Token已生成
+        lexer.reset();      // 重置索引
+    }
     nextToken();
 }
 
+Parser::Parser(Lexer &lexer, ErrorManager &errors, SymbolTable &symbols, Arena &arena)
+    : lexer(lexer), context(lexer.context()), errors(errors), symTable(symbols), arena(arena)
+{
+}
+
 // 解析入口：解析整个程序
 std::unique_ptr<Program> Parser::parse()
 {
     return parseProgram();
 }
 
+// 函数体并行解析（见 parser.h）
+std::unique_ptr<Program> Parser::parse(ThreadPool &pool)
+{
+    if (lexer.isStreaming() || pool.size() < 2)
+        return parseProgram();
+
+    // 第一遍：全局语句和函数头照常解析，函数体只做括号匹配
+    std::vector<DeferredBody> bodies;
+    deferredBodies = &bodies;
+    auto program = parseProgram();
+    deferredBodies = nullptr;
+    if (bodies.empty())
+        return program;
+
+    // 行首偏移表在第一次计算位置时建立，此后 location() 只读，可在各线程中同时调用
+    lexer.location(0);
+
+    // 相邻的函数体分成Token数大致相同的若干组，每个线程分到几组，快慢不一时空闲线程可以窃取剩下的组
+    struct BodyGroup
+    {
+        size_t first = 0;               // bodies 的下标范围 [first, last)
+        size_t last = 0;
+        ErrorManager errors;
+        Arena arena;
+        std::vector<size_t> errorEnds;  // 组内每个函数体解析完时 errors 的长度
+    };
+    size_t totalTokens = 0;
+    for (const DeferredBody &body : bodies)
+        totalTokens += body.end - body.begin;
+    size_t groupTokens = std::max<size_t>(totalTokens / (pool.size() * 4), 1);
+    std::deque<BodyGroup> groups;       // ErrorManager、Arena 不可移动，用 deque 保持地址不变
+    size_t tokensInGroup = 0;
+    for (size_t i = 0; i < bodies.size(); ++i)
+    {
+        if (groups.empty() || tokensInGroup >= groupTokens)
+        {
+            groups.emplace_back();
+            groups.back().first = i;
+            tokensInGroup = 0;
+        }
+        groups.back().last = i + 1;
+        tokensInGroup += bodies[i].end - bodies[i].begin;
+    }
+
+    // 第二遍：各组用自己的错误列表、竞技场和分层符号表，全局符号表此时只读
+    for (BodyGroup &group : groups)
+    {
+        pool.submit([this, &bodies, &group] {
+            SymbolTable locals(lexer.names(), symTable);
+            Parser worker(lexer, group.errors, locals, group.arena);
+            for (size_t i = group.first; i < group.last; ++i)
+            {
+                const DeferredBody &body = bodies[i];
+                locals.setVisibleGlobals(body.visibleGlobals);
+                worker.panicMode = false;
+                worker.cursor = body.begin;
+                worker.nextToken();
+                worker.parseFunctionBody(*body.function);
+                group.errorEnds.push_back(group.errors.getErrors().size());
+            }
+        });
+    }
+    pool.wait();
+
+    // 按源码顺序合并错误：每个函数体的错误插回顺序解析时的位置；各组的节点并入 Program 的竞技场
+    std::vector<Error> firstPass = errors.takeErrors();
+    size_t next = 0;
+    auto append = [this](const Error &error) {
+        errors.addError(error.type, error.line, error.column, error.offset, error.length, error.message);
+    };
+    for (BodyGroup &group : groups)
+    {
+        const std::vector<Error> &bodyErrors = group.errors.getErrors();
+        size_t from = 0;
+        for (size_t i = group.first; i < group.last; ++i)
+        {
+            for (; next < bodies[i].errorPosition; ++next)
+                append(firstPass[next]);
+            for (size_t to = group.errorEnds[i - group.first]; from < to; ++from)
+                append(bodyErrors[from]);
+        }
+        arena.adopt(group.arena);
+    }
+    for (; next < firstPass.size(); ++next)
+        append(firstPass[next]);
+    return program;
+}
+
 // 推进到下一个Token
 void Parser::nextToken()
 {
-    if (lexer.hasNext())
+    if (cursor >= 0)
+    {
+        const std::vector<Token> &tokens = lexer.tokenArray();
+        currentToken = cursor < static_cast<int>(tokens.size()) ? tokens[cursor++] : lexer.endToken();
+        TRACE(Parser, Verbose, "推进到Token: " << currentToken.value << " 类型: " << static_cast<int>(currentToken.type));
+    }
+    else if (lexer.hasNext())
     {
         currentToken = lexer.nextToken();
-        qDebug() << "推进到Token:" << QString::fromStdString(currentToken.value)
-                 << "类型:" << static_cast<int>(currentToken.type);
+        TRACE(Parser, Verbose, "推进到Token: " << currentToken.value << " 类型: " << static_cast<int>(currentToken.type));
     }
     else
     {
-        currentToken = {TokenType::EOF_TOKEN, "", 0, 0}; // 结束标记
+        currentToken = lexer.endToken(); // 结束标记
     }
 }
 
+// 查看当前Token之后的Token（offset 为0即下一个），不推进
+Token Parser::peekToken(int offset)
+{
+    if (cursor >= 0)
+    {
+        const std::vector<Token> &tokens = lexer.tokenArray();
+        return offset >= 0 && cursor + offset < static_cast<int>(tokens.size()) ? tokens[cursor + offset]
+                                                                                : lexer.endToken();
+    }
+    return lexer.peekAheadToken(offset);
+}
+
 // 匹配Token（类型+值）
-bool Parser::match(TokenType type, const std::string &value)
+bool Parser::match(TokenType type, std::string_view value)
 {
     if (currentToken.type == type && currentToken.value == value)
     {
@@ -104,20 +230,158 @@ bool Parser::match(TokenType type)
 }
 
 // 预期Token（类型+值），不匹配则报错
-void Parser::expect(TokenType type, const std::string &value, const std::string &errorMsg)
+bool Parser::expect(TokenType type, std::string_view value, const char *errorMsg)
 {
     if (!match(type, value))
     {
-        throw std::runtime_error(errorMsg + "（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + "）");
+        syntaxError(errorMsg);
+        return false;
     }
+    return true;
 }
 
 // 预期Token（仅类型）
-void Parser::expect(TokenType type, const std::string &errorMsg)
+bool Parser::expect(TokenType type, const char *errorMsg)
 {
     if (!match(type))
     {
-       throw std::runtime_error(errorMsg + "（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + "）");
+        syntaxError(errorMsg);
+        return false;
+    }
+    return true;
+}
+
+// 记录语法错误（位置为当前Token）并进入恐慌模式。当前Token是词法错误时 Lexer 已经报告过，
+// 只进入恐慌模式，由同步跳过该Token
+void Parser::syntaxError(const char *message)
+{
+    if (panicMode)
+        return; // 同步之前的连带错误不再报告
+    panicMode = true;
+    if (currentToken.type == TokenType::ERROR_TOKEN)
+        return;
+    SourceLocation loc = lexer.location(currentToken);
+    errors.addError(ErrorType::SYNTAX_ERROR, loc.line, loc.column,
+                                      currentToken.offset, currentToken.length, message);
+}
+
+// 记录语义错误（位置为出错的Token）
+void Parser::semanticError(ErrorType type, const Token &at, const std::string &message)
+{
+    SourceLocation loc = lexer.location(at);
+    errors.addError(type, loc.line, loc.column, at.offset, at.length, message);
+}
+
+// 记录函数调用的语义错误（位置为被调用的函数名）
+void Parser::semanticError(ErrorType type, const CallExpr &call, const std::string &message)
+{
+    errors.addError(type, call.line, call.column, call.offset, call.length, message);
+}
+
+// 括号匹配：从当前的'{'跳到与之匹配的'}'之后，不做语法分析（只用于主解析器的完整模式）。
+// 缺少'}'时停在文件结束处，顺序解析函数体时也停在那里
+void Parser::skipBlock()
+{
+    const std::vector<Token> &tokens = lexer.tokenArray();
+    int index = lexer.tokenPosition() - 1; // currentToken 的下标
+    int depth = 0;
+    for (; index < static_cast<int>(tokens.size()); ++index)
+    {
+        const Token &token = tokens[index];
+        if (token.type == TokenType::EOF_TOKEN)
+            break;
+        if (token.type == TokenType::PUNCTUATOR)
+        {
+            if (token.value == "{")
+            {
+                ++depth;
+            }
+            else if (token.value == "}" && --depth == 0)
+            {
+                ++index;
+                break;
+            }
+        }
+    }
+    lexer.seekToken(index);
+    nextToken();
+}
+
+// 当前Token能否开始一条语句（类型关键字、if/while/for/return）
+bool Parser::startsStatement() const
+{
+    if (currentToken.type != TokenType::KEYWORD)
+        return false;
+    return typeKeywords.count(currentToken.value) || currentToken.value == "if" ||
+           currentToken.value == "while" || currentToken.value == "for" || currentToken.value == "return";
+}
+
+// 当前位置是否为函数定义：类型关键字 + 标识符 + '('
+bool Parser::startsFunctionDef()
+{
+    if (currentToken.type != TokenType::KEYWORD || !typeKeywords.count(currentToken.value))
+        return false;
+    Token next1 = peekToken(0);
+    Token next2 = peekToken(1);
+    return next1.type == TokenType::IDENTIFIER &&
+           next2.type == TokenType::PUNCTUATOR &&
+           next2.value == "(";
+}
+
+// 语句级同步：遇到';'吃掉后停下；遇到不在被跳过代码块内的'}'、语句起始关键字或文件结束时停下。
+// 途中的'{'...'}'整体跳过，避免把内层的'}'误当作所在代码块的结束
+void Parser::synchronizeStatement()
+{
+    panicMode = false;
+    int depth = 0;
+    while (currentToken.type != TokenType::EOF_TOKEN)
+    {
+        if (currentToken.type == TokenType::PUNCTUATOR)
+        {
+            if (currentToken.value == "{")
+            {
+                ++depth;
+            }
+            else if (currentToken.value == "}")
+            {
+                if (depth == 0)
+                    return;
+                nextToken();
+                if (--depth == 0)
+                    return; // 跳过了一个完整的代码块
+                continue;
+            }
+            else if (currentToken.value == ";" && depth == 0)
+            {
+                nextToken();
+                return;
+            }
+        }
+        else if (depth == 0 && startsStatement())
+        {
+            return;
+        }
+        nextToken();
+    }
+}
+
+// 函数级同步：跳到下一个函数定义的开头（途中的代码块整体跳过）或文件结束
+void Parser::synchronizeFunction()
+{
+    panicMode = false;
+    int depth = 0;
+    while (currentToken.type != TokenType::EOF_TOKEN)
+    {
+        if (depth == 0 && startsFunctionDef())
+            return;
+        if (currentToken.type == TokenType::PUNCTUATOR)
+        {
+            if (currentToken.value == "{")
+                ++depth;
+            else if (currentToken.value == "}" && depth > 0)
+                --depth;
+        }
+        nextToken();
     }
 }
 
@@ -125,108 +389,117 @@ void Parser::expect(TokenType type, const std::string &errorMsg)
 std::unique_ptr<Program> Parser::parseProgram()
 {
     auto program = std::make_unique<Program>();
-    qDebug() << "开始解析程序...";
+    program->arena = context.sharedArena();
+    program->names = context.sharedNames();
+    TRACE(Parser, Info, "开始解析程序...");
 
     while (currentToken.type != TokenType::EOF_TOKEN)
     {
-        // 添加详细日志
-        qDebug() << "当前Token:" << QString::fromStdString(currentToken.value)
-                 << "类型:" << static_cast<int>(currentToken.type);
+        TRACE(Parser, Verbose, "当前Token: " << currentToken.value << " 类型: " << static_cast<int>(currentToken.type));
         // 如果没有更多Token，跳出循环
         if (!lexer.hasNext()) {
             break;
         }
-        // 尝试解析函数定义
-        bool isFunctionDef = false;
-        if (currentToken.type == TokenType::KEYWORD && typeKeywords.count(currentToken.value))
+        int start = currentToken.offset;
+        if (startsFunctionDef())
         {
-            Token next1 = lexer.peekNextToken();
-            Token next2 = lexer.peekAheadToken(1);
-            if (next1.type == TokenType::IDENTIFIER &&
-                next2.type == TokenType::PUNCTUATOR &&
-                next2.value == "(")
+            // 尝试解析函数定义；函数头出错时跳到下一个函数定义
+            auto func = parseFunctionDef();
+            if (func)
             {
-                isFunctionDef = true;
+                program->functions.push_back(func);
+            }
+            if (panicMode)
+            {
+                synchronizeFunction();
             }
-        }
-
-        if (isFunctionDef)
-        {
-            program->functions.push_back(parseFunctionDef());
         }
         else
         {
             // 解析全局语句
-            qDebug() << "尝试解析全局语句";
-            try
+            TRACE(Parser, Verbose, "尝试解析全局语句");
+            auto stmt = parseStmt();
+            if (stmt)
             {
-                auto stmt = parseStmt();
-                if (stmt)
-                {
-                    program->statements.push_back(std::move(stmt));
-                }
+                program->statements.push_back(std::move(stmt));
             }
-            catch (const std::exception &e)
+            if (panicMode)
             {
-                qDebug() << "解析语句失败:" << e.what();
-                if (currentToken.type != TokenType::EOF_TOKEN)
-                { // 跳过错误Token
-                    nextToken();
-                }else break;
+                synchronizeStatement();
             }
         }
+        if (currentToken.offset == start && currentToken.type != TokenType::EOF_TOKEN)
+        {
+            nextToken(); // 出错后同步点就是当前Token（如全局的多余'}'）时，至少前进一个，保证解析能结束
+        }
     }
 
-    qDebug() << "解析完成，找到" << program->functions.size() << "个函数,"
-             << program->statements.size() << "条全局语句";
+    TRACE(Parser, Info, "解析完成，找到 " << program->functions.size() << " 个函数, "
+                                           << program->statements.size() << " 条全局语句");
     return program;
 }
 
 // 解析FunctionDef：返回类型 + 函数名 + 参数列表 + 函数体
-std::unique_ptr<FunctionDef> Parser::parseFunctionDef()
+ArenaPtr<FunctionDef> Parser::parseFunctionDef()
+{
+    auto func = parseFunctionHeader();
+    if (!func)
+        return nullptr;
+    if (deferredBodies && currentToken.type == TokenType::PUNCTUATOR && currentToken.value == "{")
+    {
+        // 并行模式第一遍：记下函数体的位置和此刻的全局状态，跳过函数体
+        DeferredBody body;
+        body.function = func.get();
+        body.begin = lexer.tokenPosition() - 1;
+        body.visibleGlobals = symTable.globalDeclarationCount();
+        body.errorPosition = errors.getErrors().size();
+        skipBlock();
+        body.end = lexer.tokenPosition() - 1;
+        deferredBodies->push_back(body);
+        return func;
+    }
+    if (!parseFunctionBody(*func))
+        return nullptr;
+    return func;
+}
+
+// 函数头：返回类型 + 函数名 + 参数列表；函数符号登记在全局作用域，函数体中可以递归调用
+ArenaPtr<FunctionDef> Parser::parseFunctionHeader()
 {
-    auto func = std::make_unique<FunctionDef>();
+    auto func = arena.make<FunctionDef>();
 
     // 解析返回类型（支持多种类型）
     if (currentToken.type != TokenType::KEYWORD || !typeKeywords.count(currentToken.value))
     {
-        throw std::runtime_error(
-            "函数定义需以有效类型开头（位置：行" + std::to_string(currentToken.line) +
-            ", 列" + std::to_string(currentToken.column) + "）");
-        //ErrorManager::instance().addError(ErrorType::SYNTAX_ERROR,currentToken.line,
-        //    currentToken.column,"函数定义需以有效类型开头" );
+        syntaxError("函数定义需以有效类型开头");
+        return nullptr;
     }
-    func->returnType = currentToken.value; // 动态获取返回
+    func->returnType = currentToken.id; // 动态获取返回
     nextToken();
     // 解析函数名（标识符）
-    std::string funcName = currentToken.value; // 保存当前Token值
-    expect(TokenType::IDENTIFIER, "函数名应为标识符");
+    int funcName = currentToken.id; // 保存当前Token值
+    if (!expect(TokenType::IDENTIFIER, "函数名应为标识符"))
+        return nullptr;
     func->name = funcName; // 注意：match后currentToken已更新，需用匹配前的值
     // 解析参数列表
-    expect(TokenType::PUNCTUATOR, "(", "函数名后应跟'('");
-    std::vector<Param> params;
-    std::vector<std::pair<std::string, std::string>> paramList; // 参数名-类型对
+    if (!expect(TokenType::PUNCTUATOR, "(", "函数名后应跟'('"))
+        return nullptr;
+    ArenaList<Param> params;
+    std::vector<std::pair<int, int>> paramList; // 参数名-类型对
     if (!match(TokenType::PUNCTUATOR, ")"))
     {                                    // 如果不是直接闭合的括号
         params = parseParamList(); // 解析参数列表
+        if (panicMode)
+            return nullptr;
         // 将Param转换为符号表所需的格式
         for (const auto& param : params)
         {
             paramList.emplace_back(param.name, param.type);
         }
-        expect(TokenType::PUNCTUATOR, ")", "参数列表后应跟')'");
+        if (!expect(TokenType::PUNCTUATOR, ")", "参数列表后应跟')'"))
+            return nullptr;
     }
     func->params=params;
-    for (const auto& param : params)
-    {
-        Symbol paramSym;
-        paramSym.name = param.name;
-        paramSym.type = param.type;
-        paramSym.scope = symTable.getCurrentScope();
-        paramSym.is_function = false;
-        symTable.insert(paramSym);
-        qDebug() << "已添加参数符号: " << param.name.c_str() << " (类型: " << param.type.c_str() << ")";
-    }
     Symbol funcSym;
     funcSym.name = funcName;
     funcSym.type = func->returnType;
@@ -234,41 +507,55 @@ std::unique_ptr<FunctionDef> Parser::parseFunctionDef()
     funcSym.is_function = true;
     funcSym.params = paramList;
     symTable.insert(funcSym);
-    // 解析函数体（Block）
-    func->body = parseBlock();
-
-    qDebug() << "解析函数: " << func->name
-             << " (返回类型: " << func->returnType << ")\n";
+    return func;
+}
 
-    if (func->body)
+// 函数体：参数登记在函数自己的作用域中（只在本函数内可见），再解析代码块；
+// 函数体内的错误由 parseBlock 自行恢复，只有缺少'{'时返回false
+bool Parser::parseFunctionBody(FunctionDef& func)
+{
+    symTable.enterScope();
+    for (const auto& param : func.params)
     {
-        qDebug() << "  函数体包含 " << func->body->statements.size() << " 条语句\n";
+        Symbol paramSym;
+        paramSym.name = param.name;
+        paramSym.type = param.type;
+        paramSym.scope = symTable.getCurrentScope();
+        paramSym.is_function = false;
+        symTable.insert(paramSym);
+        TRACE(Symbol, Debug, "已添加参数符号: " << nameText(param.name) << " (类型: " << nameText(param.type) << ")");
     }
-    return func;
+    func.body = parseBlock();
+    symTable.leaveScope();
+    if (!func.body)
+        return false;
+
+    TRACE(Parser, Debug, "解析函数: " << nameText(func.name)
+                                      << " (返回类型: " << nameText(func.returnType) << ")");
+    TRACE(Parser, Debug, "  函数体包含 " << func.body->statements.size() << " 条语句");
+    return true;
 }
 
 // 解析ParamList：参数列表（Param ("," Param)*）
-std::vector<Param> Parser::parseParamList()
+ArenaList<Param> Parser::parseParamList()
 {
-    std::vector<Param> params;
+    ArenaList<Param> params;
 
     // 解析第一个参数
     Param firstParam;
     if (currentToken.type != TokenType::KEYWORD || !typeKeywords.count(currentToken.value))
     {
-        throw std::runtime_error(
-            "参数类型应为有效类型（位置：行" + std::to_string(currentToken.line) +
-            ", 列" + std::to_string(currentToken.column) + "）");
-        //ErrorManager::instance().addError(ErrorType::TYPE_MISMATCH,currentToken.line,
-                //currentToken.column,"参数类型应为有效类型:"+currentToken.value);
+        syntaxError("参数类型应为有效类型");
+        return params;
     }
-    firstParam.type = currentToken.value;
+    firstParam.type = currentToken.id;
     nextToken();
 
-    std::string firstParamName = currentToken.value;
-    expect(TokenType::IDENTIFIER, "参数名应为标识符");
+    int firstParamName = currentToken.id;
+    if (!expect(TokenType::IDENTIFIER, "参数名应为标识符"))
+        return params;
     firstParam.name = firstParamName; // 同样需修正为匹配前的值
-    params.push_back(firstParam);
+    params.push_back(arena, firstParam);
 
     // 解析后续参数（"," Param）
     while (match(TokenType::PUNCTUATOR, ","))
@@ -277,35 +564,50 @@ std::vector<Param> Parser::parseParamList()
         // expect(TokenType::KEYWORD, "int", "参数类型应为'int'");
         if (currentToken.type != TokenType::KEYWORD || !typeKeywords.count(currentToken.value))
         {
-            throw std::runtime_error(
-                "参数类型应为有效类型（位置：行" + std::to_string(currentToken.line) +
-                ", 列" + std::to_string(currentToken.column) + "）");
-            //ErrorManager::instance().addError(ErrorType::TYPE_MISMATCH,currentToken.line,
-                    //currentToken.column,"参数类型应为有效类型:"+currentToken.value);
+            syntaxError("参数类型应为有效类型");
+            return params;
         }
-        param.type = currentToken.value;
+        param.type = currentToken.id;
         nextToken();
 
-        std::string paramName = currentToken.value;
-        expect(TokenType::IDENTIFIER, "参数名应为标识符");
+        int paramName = currentToken.id;
+        if (!expect(TokenType::IDENTIFIER, "参数名应为标识符"))
+            return params;
         param.name = paramName; // 修正同上
-        params.push_back(param);
+        params.push_back(arena, param);
     }
 
     return params;
 }
 
 // 解析Block：代码块（"{" Stmt* "}"）
-std::unique_ptr<Block> Parser::parseBlock()
+ArenaPtr<Block> Parser::parseBlock()
 {
-    auto block = std::make_unique<Block>();
-    expect(TokenType::PUNCTUATOR, "{", "代码块应以'{'开头");
+    auto block = arena.make<Block>();
+    if (!expect(TokenType::PUNCTUATOR, "{", "代码块应以'{'开头"))
+        return nullptr;
     //进入新作用域
-    symTable.enterScope("block_" + std::to_string(symTable.getScopeCount()));
-    // 解析语句列表（Stmt*）
+    symTable.enterScope();
+    // 解析语句列表（Stmt*）；出错的语句丢弃，同步到语句边界后继续解析下一条
     while (!match(TokenType::PUNCTUATOR, "}"))
     {                                             // 直到遇到"}"
-        block->statements.push_back(parseStmt()); // 解析一条语句
+        if (currentToken.type == TokenType::EOF_TOKEN)
+        {
+            syntaxError("代码块缺少闭合'}'");
+            break;
+        }
+        int start = currentToken.offset;
+        auto stmt = parseStmt(); // 解析一条语句
+        if (stmt)
+        {
+            block->statements.push_back(arena, stmt);
+        }
+        if (panicMode)
+        {
+            synchronizeStatement();
+            if (currentToken.offset == start && currentToken.type != TokenType::EOF_TOKEN)
+                nextToken(); // 保证至少前进一个Token
+        }
     }
     // 退出当前作用域
     symTable.leaveScope();
@@ -313,7 +615,7 @@ std::unique_ptr<Block> Parser::parseBlock()
 }
 
 // 解析Stmt：根据当前Token判断语句类型
-std::unique_ptr<Stmt> Parser::parseStmt()
+ArenaPtr<Stmt> Parser::parseStmt()
 {
     if (currentToken.type == TokenType::KEYWORD && typeKeywords.count(currentToken.value))
     {
@@ -324,7 +626,7 @@ std::unique_ptr<Stmt> Parser::parseStmt()
     {
         // 可能是赋值语句（a = 20;）或表达式语句（printf(...);）
         // 先尝试匹配赋值（检查下一个Token是否为"="）
-        Token next = lexer.peekNextToken(); // 假设Lexer有peek方法，查看下一个Token不推进
+        Token next = peekToken(0); // 查看下一个Token，不推进
         if (next.type == TokenType::OPERATOR && next.value == "=")
         {
             return parseAssignStmt();
@@ -352,26 +654,24 @@ std::unique_ptr<Stmt> Parser::parseStmt()
     }
     else
     {
-        throw std::runtime_error(
-            "未知语句类型（位置：行" + std::to_string(currentToken.line) +
-            ", 列" + std::to_string(currentToken.column) + "）");
-        //ErrorManager::instance().addError(ErrorType::SYNTAX_ERROR,currentToken.line,
-                                          //currentToken.column,"未知语句类型:"+currentToken.value);
+        syntaxError("未知语句类型");
+        return nullptr;
     }
 }
 
 // 解析DeclareStmt：声明语句（int a = 10;）
-std::unique_ptr<DeclareStmt> Parser::parseDeclareStmt(bool consumeSemicolon)
+ArenaPtr<DeclareStmt> Parser::parseDeclareStmt(bool consumeSemicolon)
 {
-    auto stmt = std::make_unique<DeclareStmt>();
+    auto stmt = arena.make<DeclareStmt>();
 
     // 获取类型关键字（动态支持所有数据类型关键字）
-    stmt->type = currentToken.value;
+    stmt->type = currentToken.id;
     nextToken();
 
     // 变量名（标识符）
-    std::string varName = currentToken.value;
-    expect(TokenType::IDENTIFIER, "声明语句中变量名应为标识符");
+    int varName = currentToken.id;
+    if (!expect(TokenType::IDENTIFIER, "声明语句中变量名应为标识符"))
+        return nullptr;
     stmt->varName = varName; // 修正为匹配前的值
     // 添加到符号表（记录变量）
     Symbol varSym;
@@ -386,12 +686,15 @@ std::unique_ptr<DeclareStmt> Parser::parseDeclareStmt(bool consumeSemicolon)
         stmt->initValue = parseExpr(); // 解析初始化表达式
         varSym.is_initialized = true;
     }else  varSym.is_initialized = false;
-    symTable.insert(varSym);
+    symTable.insert(varSym); // 初始化表达式出错时变量仍然登记，避免后续使用处的连带错误
+    if (panicMode)
+        return nullptr;
     // nextToken();  // 跳过标识符
     //  语句结束符";"
     if (consumeSemicolon)
     {
-        expect(TokenType::PUNCTUATOR, ";", "声明语句应以';'结束");
+        if (!expect(TokenType::PUNCTUATOR, ";", "声明语句应以';'结束"))
+            return nullptr;
     }
     //expect(TokenType::PUNCTUATOR, ";", "声明语句应以';'结束");
     // program->statements.push_back(stmt);
@@ -400,54 +703,62 @@ std::unique_ptr<DeclareStmt> Parser::parseDeclareStmt(bool consumeSemicolon)
 
 // 获取表达式的数据类型
 // 参数: expr - 表达式AST节点
-// 返回: 类型字符串（如"int"、"char"等）
-std::string Parser::getExprType(Expr *expr)
+// 返回: 类型名的驻留表编号（如"int"、"char"等）
+int Parser::getExprType(Expr *expr)
 {
     if (!expr)
     {
-        throw std::runtime_error("空表达式节点（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + ")");
-        //ErrorManager::instance().addError(ErrorType::UNDEFINED_VARIABLE,currentToken.line,
-                                          //currentToken.column,"空表达式节点");
+        return -1; // 表达式解析失败，错误已报告
     }
 
     // 处理基础表达式（数字、标识符、函数调用等）
     if (auto *primaryExpr = dynamic_cast<PrimaryExpr *>(expr))
     {
-        switch (primaryExpr->type)
+        switch (primaryExpr->kind())
         {
         case PrimaryExpr::IDENTIFIER:
             // 变量引用：从符号表查询类型
             {
-                Symbol *sym = symTable.lookup(primaryExpr->identifier);
-                if (!sym)
-                {
-                    throw std::runtime_error("未声明的标识符: " + primaryExpr->identifier +
-                                             "（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + ")");
-                    //ErrorManager::instance().addError(ErrorType::UNDEFINED_VARIABLE,currentToken.line,
-                                                      //currentToken.column,"未声明的标识符:"+primaryExpr->identifier);
-                }
-                return sym->type;
+                const Symbol *sym = symTable.lookup(primaryExpr->identifier());
+                return sym ? sym->type : -1; // 未声明的标识符已在 parsePrimaryExpr 中报告
             }
         case PrimaryExpr::NUMBER:
             // 数字字面量默认为int类型
-            return "int";
+            return TYPE_INT;
         case PrimaryExpr::CALL_EXPR:
             // 函数调用：从符号表查询函数返回类型
             {
-                Symbol *sym = symTable.lookup(primaryExpr->callExpr->callee);
+                CallExpr *call = primaryExpr->callExpr();
+                const Symbol *sym = symTable.lookup(call->callee);
                 if (!sym)
                 {
-                    throw std::runtime_error("未声明的函数: " + primaryExpr->callExpr->callee +
-                                             "（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + ")");
-                    //ErrorManager::instance().addError(ErrorType::UNDEFINED_VARIABLE,currentToken.line,
-                                                      //currentToken.column,"未声明的函数: " + primaryExpr->callExpr->callee);
+                    return -1; // 未声明的函数已在 parsePrimaryExpr 中报告
+                }
+                // 存在重载时按实参类型在签名索引中选出对应的定义
+                if (sym->is_function && symTable.overloadCount(call->callee) > 1)
+                {
+                    std::vector<int> argTypes;
+                    argTypes.reserve(call->arguments.size());
+                    for (Expr *arg : call->arguments)
+                    {
+                        int argType = getExprType(arg);
+                        if (argType < 0)
+                            return -1; // 实参类型未知，无法选择重载
+                        argTypes.push_back(argType);
+                    }
+                    sym = symTable.lookupFunction(call->callee, argTypes);
+                    if (!sym)
+                    {
+                        semanticError(ErrorType::TYPE_MISMATCH, *call,
+                                      "没有与参数类型匹配的重载函数: " + std::string(nameText(call->callee)));
+                        return -1;
+                    }
                 }
                 return sym->type;
             }
         default:
-            throw std::runtime_error("不支持的基础表达式类型（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + ")");
-            //ErrorManager::instance().addError(ErrorType::INVALID_OPERATION,currentToken.line,
-            //                                  currentToken.column,"不支持的基础表达式类型");
+            semanticError(ErrorType::INVALID_OPERATION, currentToken, "不支持的基础表达式类型");
+            return -1;
         }
     }
     // 处理二元表达式（如a + b）
@@ -458,89 +769,99 @@ std::string Parser::getExprType(Expr *expr)
     }
 
     // 其他表达式类型可在此扩展
-    //ErrorManager::instance().addError(ErrorType::INVALID_OPERATION,currentToken.line,
-    //                                  currentToken.column,"不支持的基础表达式类型");
-    throw std::runtime_error("不支持的表达式类型（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + ")");
+    semanticError(ErrorType::INVALID_OPERATION, currentToken, "不支持的表达式类型");
+    return -1;
 
 }
 
-bool Parser::isTypeCompatible(const std::string &targetType, const std::string &sourceType)
+bool Parser::isTypeCompatible(int targetType, int sourceType)
 {
-    // 基本类型匹配
-    if (targetType == sourceType)
+    // 类型未知（相关错误已报告）时不再报告类型不匹配，避免连带错误
+    if (targetType < 0 || sourceType < 0)
         return true;
 
-    // 允许隐式转换（如int→float）
-    if (targetType == "float" && sourceType == "int")
+    // 基本类型匹配（同名类型编号相同，指针类型等也由此覆盖）
+    if (targetType == sourceType)
         return true;
 
-    // 指针类型检查（简化）
-    if (targetType == "char*" && sourceType == "char*")
+    // 允许隐式转换（如int→float）
+    if (targetType == TYPE_FLOAT && sourceType == TYPE_INT)
         return true;
 
     return false;
 }
 
 // 解析AssignStmt：赋值语句（a = 20;）
-std::unique_ptr<AssignStmt> Parser::parseAssignStmt()
+ArenaPtr<AssignStmt> Parser::parseAssignStmt()
 {
-    auto stmt = std::make_unique<AssignStmt>();
+    auto stmt = arena.make<AssignStmt>();
 
     // 变量名（标识符）
-    stmt->varName = currentToken.value; // 保存当前标识符
+    stmt->varName = currentToken.id; // 保存当前标识符
     // 从符号表获取变量类型
-    Symbol *symbol = symTable.lookup(stmt->varName);
+    const Symbol *symbol = symTable.lookup(stmt->varName);
     if (!symbol)
     {
-        throw std::runtime_error("未定义的变量: " + stmt->varName +"（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + "）");
+        semanticError(ErrorType::UNDEFINED_VARIABLE, currentToken, "未定义的变量: " + std::string(nameText(stmt->varName)));
     }
-    stmt->varType = symbol->type; // 记录变量类型
+    stmt->varType = symbol ? symbol->type : -1; // 记录变量类型（未定义时为-1）
     nextToken();                  // 跳过标识符
 
     // 匹配"="
-    expect(TokenType::OPERATOR, "=", "赋值语句中应有'='");
+    if (!expect(TokenType::OPERATOR, "=", "赋值语句中应有'='"))
+        return nullptr;
     // 赋值表达式
     stmt->value = parseExpr();
+    if (panicMode)
+        return nullptr;
     stmt->exprType = getExprType(stmt->value.get()); // 获取表达式类型
 
     // 类型检查
     if (!isTypeCompatible(stmt->varType, stmt->exprType))
     {
-        throw std::runtime_error("类型不匹配: 无法将 " + stmt->exprType + " 赋值给 " + stmt->varType+"（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + "）");
+        semanticError(ErrorType::TYPE_MISMATCH, currentToken,
+                      "类型不匹配: 无法将 " + std::string(nameText(stmt->exprType)) + " 赋值给 " + std::string(nameText(stmt->varType)));
     }
 
     // 语句结束符";"
-    expect(TokenType::PUNCTUATOR, ";", "赋值语句应以';'结束");
+    if (!expect(TokenType::PUNCTUATOR, ";", "赋值语句应以';'结束"))
+        return nullptr;
 
     return stmt;
 }
 
 // 解析IfStmt：if语句（if (a > 5) { ... } else { ... }）
-std::unique_ptr<IfStmt> Parser::parseIfStmt()
+ArenaPtr<IfStmt> Parser::parseIfStmt()
 {
-    auto stmt = std::make_unique<IfStmt>();
+    auto stmt = arena.make<IfStmt>();
 
     // 跳过"if"
     nextToken();
 
     // 条件表达式（"(" Expr ")"）
-    expect(TokenType::PUNCTUATOR, "(", "if后应跟'('");
+    if (!expect(TokenType::PUNCTUATOR, "(", "if后应跟'('"))
+        return nullptr;
     stmt->condition = parseExpr(); // 解析条件
-    expect(TokenType::PUNCTUATOR, ")", "条件表达式后应跟')'");
+    if (panicMode || !expect(TokenType::PUNCTUATOR, ")", "条件表达式后应跟')'"))
+        return nullptr;
 
     // then分支语句：检查是否有大括号
     if (currentToken.type == TokenType::PUNCTUATOR && currentToken.value == "{")
     {
 
         auto block = parseBlock();
-        stmt->thenStmt = std::make_unique<CompoundStmt>(std::move(block));
+        if (panicMode)
+            return nullptr;
+        stmt->thenStmt = arena.make<CompoundStmt>(std::move(block));
     }
     else
     {
         auto singleStmt = parseStmt();
-        auto block = std::make_unique<Block>();
-        block->statements.push_back(std::move(singleStmt));
-        stmt->thenStmt = std::make_unique<CompoundStmt>(std::move(block));
+        if (panicMode)
+            return nullptr;
+        auto block = arena.make<Block>();
+        block->statements.push_back(arena, std::move(singleStmt));
+        stmt->thenStmt = arena.make<CompoundStmt>(std::move(block));
     }
     // 可选的else分支
     if (match(TokenType::KEYWORD, "else"))
@@ -549,102 +870,117 @@ std::unique_ptr<IfStmt> Parser::parseIfStmt()
         if (currentToken.type == TokenType::PUNCTUATOR && currentToken.value == "{")
         {
             auto block = parseBlock();
-            stmt->elseStmt = std::make_unique<CompoundStmt>(std::move(block));
+            if (panicMode)
+                return nullptr;
+            stmt->elseStmt = arena.make<CompoundStmt>(std::move(block));
         }
         else
         {
             stmt->elseStmt = parseStmt(); // 解析单个语句
+            if (panicMode)
+                return nullptr;
         }
     }
     return stmt;
 }
 // 解析WhileStmt：while语句（while (condition) { ... }）
-std::unique_ptr<Stmt> Parser::parseWhileStmt() {
-    //auto stmt = std::make_unique<WhileStmt>();
-    int line = currentToken.line;
-    int column = currentToken.column;
+ArenaPtr<Stmt> Parser::parseWhileStmt() {
+    //auto stmt = arena.make<WhileStmt>();
+    SourceLocation loc = lexer.location(currentToken);
     // 跳过"while"
     nextToken();
 
     // 解析条件表达式
-    expect(TokenType::PUNCTUATOR, "(", "while后应跟'('");
+    if (!expect(TokenType::PUNCTUATOR, "(", "while后应跟'('"))
+        return nullptr;
     auto condition = parseExpr();
-    expect(TokenType::PUNCTUATOR, ")", "条件表达式后应跟')'");
+    if (panicMode || !expect(TokenType::PUNCTUATOR, ")", "条件表达式后应跟')'"))
+        return nullptr;
 
     // 解析循环体（支持块语句和单语句）
-    std::unique_ptr<Stmt> body;
+    ArenaPtr<Stmt> body;
     if (currentToken.type == TokenType::PUNCTUATOR && currentToken.value == "{") {
         auto block = parseBlock();
-        body = std::make_unique<CompoundStmt>(std::move(block));
+        body = arena.make<CompoundStmt>(std::move(block));
     } else {
         body = parseStmt();
     }
+    if (panicMode)
+        return nullptr;
 
-    return std::make_unique<WhileStmt>(std::move(condition), std::move(body), line, column);
+    return arena.make<WhileStmt>(std::move(condition), std::move(body), loc.line, loc.column);
 }
 
 // 解析ForStmt：for语句（for (init; condition; increment) { ... }）
-std::unique_ptr<Stmt> Parser::parseForStmt() {
-    //auto stmt = std::make_unique<ForStmt>();
-    int line = currentToken.line;
-    int column = currentToken.column;
+ArenaPtr<Stmt> Parser::parseForStmt() {
+    //auto stmt = arena.make<ForStmt>();
+    SourceLocation loc = lexer.location(currentToken);
     // 跳过"for"
     nextToken();
-    expect(TokenType::PUNCTUATOR, "(", "for后应跟'('");
+    if (!expect(TokenType::PUNCTUATOR, "(", "for后应跟'('"))
+        return nullptr;
 
     // 解析初始化语句（可选）
-    std::unique_ptr<Stmt> init;
+    ArenaPtr<Stmt> init;
     if (currentToken.type != TokenType::PUNCTUATOR || currentToken.value != ";") {
         // 支持声明语句或表达式语句
         if (currentToken.type == TokenType::KEYWORD && typeKeywords.count(currentToken.value)) {
             init = parseDeclareStmt(false);
         } else if (currentToken.type == TokenType::IDENTIFIER &&
-                   lexer.peekNextToken().type == TokenType::OPERATOR &&
-                   lexer.peekNextToken().value == "=") {
+                   peekToken(0).type == TokenType::OPERATOR &&
+                   peekToken(0).value == "=") {
             init = parseAssignStmt();
         } else {
             init = parseExprStmt();
         }
+        if (panicMode)
+            return nullptr;
     }
-    expect(TokenType::PUNCTUATOR, ";", "初始化语句后应跟';'");
+    if (!expect(TokenType::PUNCTUATOR, ";", "初始化语句后应跟';'"))
+        return nullptr;
 
     // 解析条件表达式（可选）
-    std::unique_ptr<Expr> condition;
+    ArenaPtr<Expr> condition;
     if (currentToken.type != TokenType::PUNCTUATOR || currentToken.value != ";") {
         if (currentToken.type == TokenType::EOF_TOKEN || currentToken.value.empty()) {
-            throw std::runtime_error("条件表达式为空（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + ")");
+            syntaxError("条件表达式为空");
+            return nullptr;
         }condition = parseExpr();
         // 显式检查并消费条件表达式后的分号
-        expect(TokenType::PUNCTUATOR, ";", "条件表达式后应跟';'");
+        if (panicMode || !expect(TokenType::PUNCTUATOR, ";", "条件表达式后应跟';'"))
+            return nullptr;
     } else {
         // 没有条件表达式时跳过分号
         nextToken();
     }
 
     // 解析增量表达式（可选）
-    std::unique_ptr<Expr> increment;
+    ArenaPtr<Expr> increment;
     if (currentToken.type != TokenType::PUNCTUATOR || currentToken.value != ")") {
         increment = parseExpr();
     }
-    expect(TokenType::PUNCTUATOR, ")", "for循环增量后应跟')'");
+    if (panicMode || !expect(TokenType::PUNCTUATOR, ")", "for循环增量后应跟')'"))
+        return nullptr;
 
     // 解析循环体（支持块语句和单语句）
-    std::unique_ptr<Stmt> body;
+    ArenaPtr<Stmt> body;
     if (currentToken.type == TokenType::PUNCTUATOR && currentToken.value == "{") {
         auto block = parseBlock();
-        body = std::make_unique<CompoundStmt>(std::move(block));
+        body = arena.make<CompoundStmt>(std::move(block));
     } else {
         body = parseStmt();
     }
+    if (panicMode)
+        return nullptr;
 
-    return std::make_unique<ForStmt>(std::move(init), std::move(condition),
-                                     std::move(increment), std::move(body), line, column);
+    return arena.make<ForStmt>(std::move(init), std::move(condition),
+                                     std::move(increment), std::move(body), loc.line, loc.column);
 }
 
 // 解析ReturnStmt：return语句（return 0;）
-std::unique_ptr<ReturnStmt> Parser::parseReturnStmt()
+ArenaPtr<ReturnStmt> Parser::parseReturnStmt()
 {
-    auto stmt = std::make_unique<ReturnStmt>();
+    auto stmt = arena.make<ReturnStmt>();
 
     // 跳过"return"
     nextToken();
@@ -656,37 +992,41 @@ std::unique_ptr<ReturnStmt> Parser::parseReturnStmt()
     }
 
     // 语句结束符";"
-    expect(TokenType::PUNCTUATOR, ";", "return语句应以';'结束");
+    if (panicMode || !expect(TokenType::PUNCTUATOR, ";", "return语句应以';'结束"))
+        return nullptr;
 
     return stmt;
 }
 
 // 解析ExprStmt：表达式语句（printf("hello");）
-std::unique_ptr<ExprStmt> Parser::parseExprStmt()
+ArenaPtr<ExprStmt> Parser::parseExprStmt()
 {
-    auto stmt = std::make_unique<ExprStmt>();
+    auto stmt = arena.make<ExprStmt>();
 
     // 解析表达式
     stmt->expr = parseExpr();
 
     // 语句结束符";"
-    expect(TokenType::PUNCTUATOR, ";", "表达式语句应以';'结束");
+    if (panicMode || !expect(TokenType::PUNCTUATOR, ";", "表达式语句应以';'结束"))
+        return nullptr;
 
     return stmt;
 }
 
 // 解析Expr：表达式（入口，调用二元表达式解析）
-std::unique_ptr<Expr> Parser::parseExpr()
+ArenaPtr<Expr> Parser::parseExpr()
 {
     return parseBinaryExpr(0); // 从最低优先级开始解析
 }
 
 // 解析BinaryExpr：二元表达式（处理运算符优先级）
-std::unique_ptr<Expr> Parser::parseBinaryExpr(int minPrecedence)
+ArenaPtr<Expr> Parser::parseBinaryExpr(int minPrecedence)
 {
     // 先解析左侧基础表达式
     // auto left = parsePrimaryExpr();
-    std::unique_ptr<Expr> left = parsePrimaryExpr(); // 基类指针接收子类对象
+    ArenaPtr<Expr> left = parsePrimaryExpr(); // 基类指针接收子类对象
+    if (panicMode)
+        return nullptr;
     // 循环处理右侧运算符和表达式（优先级攀爬法）
     while (true)
     {
@@ -697,7 +1037,7 @@ std::unique_ptr<Expr> Parser::parseBinaryExpr(int minPrecedence)
         }
 
         // 获取当前运算符的优先级
-        std::string op = currentToken.value;
+        std::string_view op = currentToken.value;
         auto it = OP_PRECEDENCE.find(op);
         if (it == OP_PRECEDENCE.end())
         {
@@ -716,22 +1056,24 @@ std::unique_ptr<Expr> Parser::parseBinaryExpr(int minPrecedence)
 
         // 解析右侧表达式（优先级要求更高，避免改变运算顺序）
         auto right = parseBinaryExpr(precedence + 1);
+        if (panicMode)
+            return nullptr;
 
         // 构建二元表达式节点，合并左右表达式
-        auto binary = std::make_unique<BinaryExpr>();
+        auto binary = arena.make<BinaryExpr>();
         if (op == "+="||op == "-=") {
             // 创建 a = a + b 的形式
-            auto assign = std::make_unique<BinaryExpr>();
+            auto assign = arena.make<BinaryExpr>();
             assign->op = (op == "+=")?"+":"-";
             assign->left = std::move(left);
             assign->right = std::move(right);
-            //auto assign = std::make_unique<BinaryExpr>();
+            //auto assign = arena.make<BinaryExpr>();
             binary->op = "=";
             binary->left=std::move(left);
             binary->right = std::move(right);
             left = std::move(binary);
         } else if (op == "*="||op =="/=") {
-            auto assign = std::make_unique<BinaryExpr>();
+            auto assign = arena.make<BinaryExpr>();
             assign->op = (op == "*=")?"*":"/";
             assign->left = std::move(left);
             assign->right = std::move(right);
@@ -741,7 +1083,7 @@ std::unique_ptr<Expr> Parser::parseBinaryExpr(int minPrecedence)
             binary->right = std::move(right);
             left = std::move(binary);
         } else {
-            binary->op = op;
+            binary->op = arena.copy(op);
             binary->left = std::move(left);
             binary->right = std::move(right);
             left = std::move(binary);
@@ -752,85 +1094,83 @@ std::unique_ptr<Expr> Parser::parseBinaryExpr(int minPrecedence)
 }
 
 // 解析PrimaryExpr：基础表达式（数字、标识符、字符串、括号表达式）
-std::unique_ptr<PrimaryExpr> Parser::parsePrimaryExpr()
+ArenaPtr<PrimaryExpr> Parser::parsePrimaryExpr()
 {
-    auto expr = std::make_unique<PrimaryExpr>();
+    auto expr = arena.make<PrimaryExpr>();
 
     if (currentToken.type == TokenType::NUMBER)
     {
         // 数字
-        expr->type = PrimaryExpr::NUMBER;
-        expr->numberValue = currentToken.value; // 保存数字值（匹配前的值）
+        expr->setNumber(arena.copy(currentToken.value)); // 保存数字值（匹配前的值）
         nextToken();
     }
     else if (currentToken.type == TokenType::IDENTIFIER)
     {
         // 标识符
-        std::string ident = currentToken.value;
+        Token identToken = currentToken;
+        int identId = currentToken.id;  // 驻留表编号
         nextToken();
 
-        // 检查是否已声明
-        if (!symTable.lookup(ident))
+        // 检查是否已声明（报告后照常解析，使用处的类型记为未知）
+        if (!symTable.lookup(identId))
         {
-            throw std::runtime_error("未声明的标识符：" + ident+"（位置：行" + std::to_string(currentToken.line) + ", 列" + std::to_string(currentToken.column) + "）");
+            semanticError(ErrorType::UNDEFINED_VARIABLE, identToken, "未声明的标识符：" + std::string(nameText(identId)));
         }
 
         // 检查是否为函数调用（标识符后紧跟'('）
         if (match(TokenType::PUNCTUATOR, "("))
         {
-            expr->type = PrimaryExpr::CALL_EXPR;
-            expr->callExpr = std::make_unique<CallExpr>();
-            expr->callExpr->callee = ident; // 函数名
-
-            // 解析参数列表
-            std::vector<std::unique_ptr<Expr>> args;
+            auto call = arena.make<CallExpr>();
+            call->callee = identId; // 函数名
+            // 调用的位置记为函数名，类型检查在读完整个表达式后才进行，那时 currentToken 已不在调用处
+            SourceLocation loc = lexer.location(identToken);
+            call->line = loc.line;
+            call->column = loc.column;
+            call->offset = identToken.offset;
+            call->length = identToken.length;
+            expr->setCall(call.get());
+
+            // 解析参数列表（直接追加到 Arena 中的参数数组）
             if (!match(TokenType::PUNCTUATOR, ")"))
             {
                 // 解析第一个参数
-                args.push_back(parseExpr());
+                call->arguments.push_back(arena, parseExpr().get());
                 // 解析后续参数（逗号分隔）
-                while (match(TokenType::PUNCTUATOR, ","))
-                {
-                    args.push_back(parseExpr());
-                }
-                // 转移参数所有权到callExpr
-                for (auto &arg : args)
+                while (!panicMode && match(TokenType::PUNCTUATOR, ","))
                 {
-                    expr->callExpr->arguments.push_back(arg.release());
+                    call->arguments.push_back(arena, parseExpr().get());
                 }
-                qDebug() << "尝试匹配右括号，当前Token: " << QString::fromStdString(currentToken.value)
-                         << "(类型: " << static_cast<int>(currentToken.type) << ")";
-                expect(TokenType::PUNCTUATOR, ")", "函数调用缺少闭合')'");
+                if (panicMode)
+                    return nullptr;
+                TRACE(Parser, Verbose, "尝试匹配右括号，当前Token: " << currentToken.value
+                                       << " (类型: " << static_cast<int>(currentToken.type) << ")");
+                if (!expect(TokenType::PUNCTUATOR, ")", "函数调用缺少闭合')'"))
+                    return nullptr;
 
             }
         }
         else if (match(TokenType::OPERATOR, "++")) {
-            auto unaryExpr = std::make_unique<UnaryExpr>();
+            auto unaryExpr = arena.make<UnaryExpr>();
             unaryExpr->op = "++";
             unaryExpr->isPostfix = true;
-            auto primary = std::make_unique<PrimaryExpr>();
-            primary->type = PrimaryExpr::IDENTIFIER;
-            primary->identifier = ident;
+            auto primary = arena.make<PrimaryExpr>();
+            primary->setIdentifier(identId);
             unaryExpr->expr = std::move(primary);
-            expr->type = PrimaryExpr::UNARY_EXPR;
-            expr->unaryExpr = std::move(unaryExpr);
+            expr->setUnary(unaryExpr.get());
         }
         else if (match(TokenType::OPERATOR, "--")) {
-            auto unaryExpr = std::make_unique<UnaryExpr>();
+            auto unaryExpr = arena.make<UnaryExpr>();
             unaryExpr->op = "--";
             unaryExpr->isPostfix = true;
-            auto primary = std::make_unique<PrimaryExpr>();
-            primary->type = PrimaryExpr::IDENTIFIER;
-            primary->identifier = ident;
+            auto primary = arena.make<PrimaryExpr>();
+            primary->setIdentifier(identId);
             unaryExpr->expr = std::move(primary);
-            expr->type = PrimaryExpr::UNARY_EXPR;
-            expr->unaryExpr = std::move(unaryExpr);
+            expr->setUnary(unaryExpr.get());
         }
         else
         {
             // 普通标识符
-            expr->type = PrimaryExpr::IDENTIFIER;
-            expr->identifier = ident;
+            expr->setIdentifier(identId);
         }
         /*expr->type = PrimaryExpr::IDENTIFIER;
         expr->identifier = currentToken.value;  // 保存标识符
@@ -839,22 +1179,20 @@ std::unique_ptr<PrimaryExpr> Parser::parsePrimaryExpr()
     else if (currentToken.type == TokenType::STRING)
     {
         // 字符串字面量（如"hello"）
-        expr->type = PrimaryExpr::STRING;
-        expr->stringValue = currentToken.value; // 保存字符串值
+        expr->setString(arena.copy(currentToken.value)); // 保存字符串值
         nextToken();
     }
     else if (match(TokenType::PUNCTUATOR, "("))
     {
         // 括号表达式（(Expr)）
-        expr->type = PrimaryExpr::PAREN_EXPR;
-        expr->parenExpr = parseExpr(); // 解析括号内的表达式
-        expect(TokenType::PUNCTUATOR, ")", "括号表达式缺少闭合')'");
+        expr->setParen(parseExpr().get()); // 解析括号内的表达式
+        if (panicMode || !expect(TokenType::PUNCTUATOR, ")", "括号表达式缺少闭合')'"))
+            return nullptr;
     }
     else
     {
-        throw std::runtime_error(
-            "不支持的基础表达式（位置：行" + std::to_string(currentToken.line) +
-            ", 列" + std::to_string(currentToken.column) + "）");
+        syntaxError("不支持的基础表达式");
+        return nullptr;
     }
 
     return expr;
@@ -4,16 +4,37 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include "lexer.h"  // 依赖词法分析器的Token
 #include "ast.h"    // 依赖AST节点
 #include <unordered_set>
 #include "symbol.h"
+#include "error.h"
+
+class ThreadPool;
+
 class Parser {
 private:
     Lexer& lexer;  // 词法分析器（提供Token流）
     Token currentToken;  // 当前读取的Token
-    SymbolTable symTable; // 新增符号表
-    const std::unordered_set<std::string> typeKeywords={"int","char","float","double","void",
+    CompilationContext& context;  // 本翻译单元的编译状态（与 lexer 相同）
+    ErrorManager& errors;  // 错误列表（属于 context；并行解析函数体时为各线程自己的列表）
+    SymbolTable& symTable; // 符号表（属于 context；并行解析函数体时为分层符号表）
+    Arena& arena;          // AST节点分配在 context 的竞技场中，随 Program 一起释放
+    // 并行解析函数体时，各线程的 Parser 在 Token 数组上有自己的游标（下一个Token的下标），
+    // 不移动 lexer 的游标；为-1时使用 lexer 的游标
+    int cursor = -1;
+
+    // 并行模式中推迟到第二遍解析的函数体
+    struct DeferredBody {
+        FunctionDef* function;
+        int begin;              // 函数体'{'在Token数组中的下标
+        int end;                // 函数体之后第一个Token的下标
+        int visibleGlobals;     // 顺序解析到该函数体时已登记的全局声明个数
+        size_t errorPosition;   // 顺序解析时函数体中的错误在错误列表中的起始位置
+    };
+    std::vector<DeferredBody>* deferredBodies = nullptr;   // 非空时函数体只做括号匹配，留待并行解析
+    const std::unordered_set<std::string_view> typeKeywords={"int","char","float","double","void",
         "short",
         "long",
         "signed",
@@ -24,42 +45,68 @@ private:
 };
     // 辅助函数：推进到下一个Token
     void nextToken();
+    Token peekToken(int offset);    // 当前Token之后第 offset+1 个Token
+    void skipBlock();               // 括号匹配：跳过当前'{'开始的整个代码块，不做语法分析
 
     // 辅助函数：匹配预期的Token类型和值，不匹配则报错
-    bool match(TokenType type, const std::string& value);
+    bool match(TokenType type, std::string_view value);
     // 重载：仅匹配类型（适用于无需检查值的情况）
     bool match(TokenType type);
 
-    // 辅助函数：预期某个Token，不匹配则抛出异常（含错误位置）
-    void expect(TokenType type, const std::string& value, const std::string& errorMsg);
-    void expect(TokenType type, const std::string& errorMsg);
+    // 辅助函数：预期某个Token，不匹配则记录语法错误并返回false（不抛出异常）
+    // 错误信息只在失败时才拼接成 std::string，匹配成功的常见路径不分配内存
+    bool expect(TokenType type, std::string_view value, const char* errorMsg);
+    bool expect(TokenType type, const char* errorMsg);
+
+    // 错误恢复（恐慌模式）：语法错误记录到 context 的错误列表后置 panicMode，各解析函数随即返回 nullptr，
+    // 由最近的语句列表（代码块/全局）或函数边界调用 synchronize* 跳过Token后继续解析，
+    // 因此一遍解析即可报告文件中的全部错误，恐慌期间不再记录连带错误
+    bool panicMode = false;
+    void syntaxError(const char* message);
+    // 语义错误（未声明、类型不匹配等）：语法结构完好，只记录错误，解析照常继续
+    void semanticError(ErrorType type, const Token& at, const std::string& message);
+    void semanticError(ErrorType type, const CallExpr& call, const std::string& message);
+    void synchronizeStatement();   // 跳到语句边界：吃掉';'，或停在'}'、语句起始关键字前
+    void synchronizeFunction();    // 跳到下一个函数定义的开头
+    bool startsStatement() const;  // 当前Token能否开始一条语句（同步点）
+    bool startsFunctionDef();      // 当前位置是否为函数定义（类型 标识符 '('）
 
-    // 获取表达式的类型
-    std::string getExprType(Expr* expr);
-    bool isTypeCompatible(const std::string& targetType, const std::string& sourceType);
+    // 获取表达式的类型（类型未知时返回-1，已记录的错误不再重复报告）
+    int getExprType(Expr* expr);
+    bool isTypeCompatible(int targetType, int sourceType);
+    std::string_view nameText(int id) const { return lexer.names().str(id); }  // 驻留表编号对应的名字
     // 解析函数：对应文法规则（核心）
     std::unique_ptr<Program> parseProgram();
-    std::unique_ptr<FunctionDef> parseFunctionDef();
-    std::vector<Param> parseParamList();
-    std::unique_ptr<Block> parseBlock();
-    std::unique_ptr<Stmt> parseStmt();
-    std::unique_ptr<DeclareStmt> parseDeclareStmt(bool consumeSemicolon = true);
-    std::unique_ptr<AssignStmt> parseAssignStmt();
-    std::unique_ptr<IfStmt> parseIfStmt();
-    std::unique_ptr<ReturnStmt> parseReturnStmt();
-    std::unique_ptr<ExprStmt> parseExprStmt();
-    std::unique_ptr<Expr> parseExpr();
-    std::unique_ptr<Expr> parseBinaryExpr(int minPrecedence);  // 处理运算符优先级
-    std::unique_ptr<PrimaryExpr> parsePrimaryExpr();
-    std::unique_ptr<Stmt> parseWhileStmt(); // 添加while循环解析函数声明
-    std::unique_ptr<Stmt> parseForStmt();
-    //std::unique_ptr<WhileStmt> parseWhileStmt();
+    ArenaPtr<FunctionDef> parseFunctionDef();
+    ArenaPtr<FunctionDef> parseFunctionHeader();    // 返回类型、函数名和参数，并登记函数符号
+    bool parseFunctionBody(FunctionDef& func);      // 参数作用域和函数体
+    ArenaList<Param> parseParamList();
+    ArenaPtr<Block> parseBlock();
+    ArenaPtr<Stmt> parseStmt();
+    ArenaPtr<DeclareStmt> parseDeclareStmt(bool consumeSemicolon = true);
+    ArenaPtr<AssignStmt> parseAssignStmt();
+    ArenaPtr<IfStmt> parseIfStmt();
+    ArenaPtr<ReturnStmt> parseReturnStmt();
+    ArenaPtr<ExprStmt> parseExprStmt();
+    ArenaPtr<Expr> parseExpr();
+    ArenaPtr<Expr> parseBinaryExpr(int minPrecedence);  // 处理运算符优先级
+    ArenaPtr<PrimaryExpr> parsePrimaryExpr();
+    ArenaPtr<Stmt> parseWhileStmt(); // 添加while循环解析函数声明
+    ArenaPtr<Stmt> parseForStmt();
+    //ArenaPtr<WhileStmt> parseWhileStmt();
+    // 并行解析函数体的工作线程使用（仅 parse(ThreadPool&) 内部）：错误、符号表和竞技场由调用方提供
+    Parser(Lexer& lexer, ErrorManager& errors, SymbolTable& symbols, Arena& arena);
 public:
-    // 构造函数：接收词法分析器
+    // 构造函数：接收词法分析器，错误、符号表和竞技场都使用词法分析器所属的 CompilationContext
     explicit Parser(Lexer& lexer);
 
     // 解析入口：返回整个程序的AST
     std::unique_ptr<Program> parse();
+    // 同上，但函数体在线程池中并行解析：第一遍解析全局语句和函数头、登记全局符号，
+    // 函数体只做括号匹配；第二遍各线程在只读的全局符号表上解析函数体。
+    // 得到的AST和错误（含顺序）与 parse() 完全相同。按需扫描模式下退回顺序解析。
+    // 内部会等待线程池，不能在该线程池的任务中调用
+    std::unique_ptr<Program> parse(ThreadPool& pool);
 };
 
 #endif // PARSER_H
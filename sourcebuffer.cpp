@@ -0,0 +1,136 @@
+// sourcebuffer.cpp
+#include "sourcebuffer.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SourceBuffer::SourceBuffer(std::string text) : owned(std::move(text)), data(owned) {
+}
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    owned = std::move(other.owned);
+    mapping = other.mapping;
+    mappingSize = other.mappingSize;
+#ifdef _WIN32
+    mappingHandle = other.mappingHandle;
+    other.mappingHandle = nullptr;
+#endif
+    // 短字符串移动后地址会变，非映射时视图须重新指向自己的 owned
+    data = mapping ? other.data : std::string_view(owned);
+    other.mapping = nullptr;
+    other.mappingSize = 0;
+    other.owned.clear();
+    other.data = std::string_view();
+    return *this;
+}
+
+void SourceBuffer::release() {
+    if (mapping) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+#else
+        munmap(mapping, mappingSize);
+#endif
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+    owned.clear();
+    data = std::string_view();
+}
+
+void SourceBuffer::replace(size_t offset, size_t length, std::string_view text) {
+    if (mapping) {
+        std::string copy(data);
+        release();
+        owned = std::move(copy);
+    }
+    owned.replace(offset, length, text);
+    data = owned;
+}
+
+namespace {
+
+// 映射失败时的退路：整体读入内存
+SourceBuffer readWhole(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("无法打开文件: " + path);
+    }
+    std::ostringstream content;
+    content << in.rdbuf();
+    if (in.bad()) {
+        throw std::runtime_error("读取文件失败: " + path);
+    }
+    return SourceBuffer(content.str());
+}
+
+} // namespace
+
+SourceBuffer SourceBuffer::fromFile(const std::string& path) {
+    SourceBuffer buffer;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("无法打开文件: " + path);
+    }
+    LARGE_INTEGER size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return readWhole(path);
+    }
+    HANDLE handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);  // 映射对象持有文件的引用
+    if (!handle) {
+        return readWhole(path);
+    }
+    void* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(handle);
+        return readWhole(path);
+    }
+    buffer.mappingHandle = handle;
+    buffer.mappingSize = static_cast<size_t>(size.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("无法打开文件: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        close(fd);
+        return readWhole(path);
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // 映射建立后即可关闭描述符
+    if (view == MAP_FAILED) {
+        return readWhole(path);
+    }
+    madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);  // 词法分析从头到尾顺序读
+    buffer.mappingSize = static_cast<size_t>(info.st_size);
+#endif
+    buffer.mapping = view;
+    buffer.data = std::string_view(static_cast<const char*>(view), buffer.mappingSize);
+    return buffer;
+}
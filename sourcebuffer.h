@@ -0,0 +1,44 @@
+// sourcebuffer.h
+#ifndef SOURCEBUFFER_H
+#define SOURCEBUFFER_H
+
+#include <string>
+#include <string_view>
+
+// 只读源码缓冲区：要么持有一个 std::string，要么持有文件的只读内存映射。
+// Lexer 直接在 view() 上扫描，大文件不必再复制一份到内存里。只能移动，不能复制
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+    explicit SourceBuffer(std::string text);
+    ~SourceBuffer();
+
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    // 以只读方式映射文件；无法映射时（空文件、管道、设备等）退回到整体读入。
+    // 文件无法打开或读取失败时抛出 std::runtime_error
+    static SourceBuffer fromFile(const std::string& path);
+
+    // 把 [offset, offset + length) 替换为 text（编辑器中的增量编辑）。映射的文件先复制一份自己持有；
+    // 之后就地修改，容量不够时按倍数扩容，地址可能改变，调用方须按新的 view() 更新视图
+    void replace(size_t offset, size_t length, std::string_view text);
+
+    std::string_view view() const { return data; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    void release();
+
+    std::string owned;          // 非映射时的存储
+    std::string_view data;      // 指向 owned 或映射区域
+    void* mapping = nullptr;    // 映射区域起始地址，未映射时为空
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void* mappingHandle = nullptr;  // CreateFileMapping 返回的句柄
+#endif
+};
+
+#endif // SOURCEBUFFER_H
@@ -1,137 +1,260 @@
 // Symbol.h
+#ifndef SYMBOL_H
+#define SYMBOL_H
+#include <algorithm>
+#include <climits>
 #include <string>
 #include <vector>
+#include <deque>
 #include <unordered_map>
-#include <QDebug>
 #include "error.h"
+#include "interner.h"
+#include "builtins.h"
+#include "trace.h"
+// 名字和类型都保存为驻留表编号（与 Token::id、AST 中的编号一致），比较与哈希都只涉及整数
 struct Symbol {
-    std::string name;      // 变量/函数名（如a、main）
-    std::string type;      // 类型（如int、char*、void）
-    std::string scope;     // 作用域（如global、main、block_1）
+    int name = -1;         // 变量/函数名（如a、main）
+    int type = -1;         // 类型（如int、char*、void）
+    int scope = 0;         // 作用域层级（0 为全局）
     bool is_function = false; // 是否是函数
     bool is_initialized = false; // 变量是否初始化（仅用于变量）
-    std::vector<std::pair<std::string, std::string>> params; // 参数名-类型对（仅用于函数）
+    std::vector<std::pair<int, int>> params; // 参数名-类型对（仅用于函数）
 };
+// 函数签名：函数名编号后跟各参数类型编号（长度隐含参数个数）
+using FunctionSignature = std::vector<int>;
+
+struct FunctionSignatureHash {
+    size_t operator()(const FunctionSignature& signature) const {
+        size_t h = signature.size();
+        for (int id : signature) h = h * 1000003u ^ static_cast<size_t>(id);
+        return h;
+    }
+};
+
+// 按（函数名，参数个数，参数类型）索引的函数表，一次哈希查找即可解析调用；同名不同参数的重载各占一项
+using FunctionIndex = std::unordered_map<FunctionSignature, const Symbol*, FunctionSignatureHash>;
+
+inline FunctionSignature signatureOf(const Symbol& function) {
+    FunctionSignature signature;
+    signature.reserve(function.params.size() + 1);
+    signature.push_back(function.name);
+    for (const auto& param : function.params) signature.push_back(param.second);
+    return signature;
+}
+
+// 内置函数表：由 builtins.h 中的编译期常量生成，首次使用时构建一次，所有符号表共用且只读
+struct BuiltinSymbols {
+    std::vector<Symbol> symbols;
+    std::vector<const Symbol*> byName;  // 下标为预定义名字的序号（编号 - KEYWORD_COUNT）
+    FunctionIndex index;
+
+    static const BuiltinSymbols& instance() {
+        static const BuiltinSymbols table;
+        return table;
+    }
+
+    const Symbol* find(int name) const {
+        int slot = name - KEYWORD_COUNT;
+        return slot >= 0 && slot < PREDEFINED_NAME_COUNT ? byName[slot] : nullptr;
+    }
+
+private:
+    BuiltinSymbols() : byName(PREDEFINED_NAME_COUNT, nullptr) {
+        symbols.reserve(BUILTIN_FUNCTION_COUNT);    // 之后不再扩容，指针保持有效
+        for (const BuiltinFunction& func : BUILTIN_FUNCTIONS) {
+            Symbol sym;
+            sym.name = func.name;
+            sym.type = func.returnType;
+            sym.is_function = true;
+            sym.scope = 0;
+            for (int k = 0; k < func.paramCount; ++k) {
+                sym.params.emplace_back(func.paramNames[k], func.paramTypes[k]);
+            }
+            symbols.push_back(std::move(sym));
+            const Symbol* stored = &symbols.back();
+            if (!byName[func.name - KEYWORD_COUNT]) byName[func.name - KEYWORD_COUNT] = stored;
+            index.emplace(signatureOf(*stored), stored);
+        }
+    }
+};
+
+// 扁平作用域符号表：所有作用域的符号按声明顺序存放在 entries 中，heads[名字编号] 指向该名字
+// 当前可见的（最内层）声明，每个声明再链到被它遮蔽的外层同名声明。
+// 查找只需一次数组下标访问；进入作用域只记录 entries 的当前长度，不分配内存；
+// 退出作用域时按逆序弹出本作用域新增的符号并恢复被遮蔽的声明（entries 本身就是撤销日志）。
+// 内置函数视为全局作用域中已声明的符号，但存放在共用的 BuiltinSymbols 中，不随每个符号表重建。
+// 并行解析函数体时，每个线程用一个分层符号表：自己只保存函数内的作用域，全局符号从只读的
+// 全局符号表中查找。全局声明按登记顺序编号，分层符号表只看得到编号小于 setVisibleGlobals()
+// 所设上限的声明，与顺序解析到该函数时看到的全局作用域一致
 class SymbolTable {
 public:
-    SymbolTable() {
-        enterScope("global");
-        registerBuiltinFunctions(); // 调用批量注册方法
+    // names 为本次编译共用的驻留表（与 Lexer 相同，已预先驻留关键字和内置函数用到的名字）
+    explicit SymbolTable(const StringInterner& names) : names(names) {
+        enterScope();
+    }
+    // 分层符号表：globals 在本表使用期间不得修改
+    SymbolTable(const StringInterner& names, const SymbolTable& globals) : names(names), globals(&globals) {
+        enterScope();
+    }
+
+    // 分层符号表可见的全局声明个数
+    void setVisibleGlobals(int count) { visibleGlobals = count; }
+    // 已登记的全局声明个数（全局变量与函数定义，函数的每个重载各算一个）
+    int globalDeclarationCount() const { return declarationCount; }
+
+    // 清空全部符号，回到只有全局作用域的初始状态
+    void clear() {
+        entries.clear();
+        heads.clear();
+        scopeStarts.clear();
+        functions.clear();
+        userFunctions.clear();
+        overloadOrders.clear();
+        declarationCount = 0;
+        enterScope();
     }
 
     // 进入新作用域（如函数、代码块）
-    void enterScope(const std::string& scopeName) {
-        scopes.emplace_back(); // 压入新作用域（空哈希表）
-        scopeNames.push_back(scopeName); // 添加作用域名称到栈
-        currentScopeName = scopeName;
+    void enterScope() {
+        scopeStarts.push_back(entries.size());
     }
 
-    std::string getCurrentScope() const {
-        return currentScopeName;
+    int getCurrentScope() const {
+        return static_cast<int>(scopeStarts.size()) - 1;
     }
 
     // 退出当前作用域
     void leaveScope() {
-        if (!scopes.empty()) {
-            scopes.pop_back();
-            scopeNames.pop_back(); // 弹出作用域名称栈
-            // 安全获取当前作用域名称
-            currentScopeName = scopeNames.empty() ? "global" : scopeNames.back();
+        if (scopeStarts.empty()) return;
+        size_t start = scopeStarts.back();
+        scopeStarts.pop_back();
+        while (entries.size() > start) {
+            const Entry& entry = entries.back();
+            heads[entry.symbol.name] = entry.shadowed;
+            entries.pop_back();
         }
     }
 
 
-    // 插入符号（声明时调用，返回false表示重复声明）
+    // 插入符号（声明时调用，返回false表示重复声明）。
+    // 函数允许重载：同名但参数类型不同的定义都会登记到函数索引中，只有签名完全相同才算重复
     bool insert(const Symbol& sym) {
-        if (scopes.empty()) return false;
-        auto& current = scopes.back();
-        if (current.count(sym.name)) return false; // 同一作用域重复声明
-        current[sym.name] = sym;
-        return true;
+        if (sym.is_function) return insertFunction(sym);
+        return insertEntry(sym);
     }
 
-    // 查找符号（从当前作用域往上找，返回nullptr表示未找到）
-    Symbol* lookup(const std::string& name) {
-        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-            if (it->count(name)) {
-                return &it->at(name);
+    // 查找符号（最内层可见的声明，返回nullptr表示未找到）；重载函数返回最先声明的那个
+    const Symbol* lookup(int name) const {
+        if (name >= 0 && name < static_cast<int>(heads.size()) && heads[name] != NONE) {
+            return &entries[heads[name]].symbol;
+        }
+        if (globals) {
+            // 全局作用域中同名声明不会重复登记，每个名字至多一项
+            const std::vector<int>& globalHeads = globals->heads;
+            if (name >= 0 && name < static_cast<int>(globalHeads.size()) && globalHeads[name] != NONE) {
+                const Entry& entry = globals->entries[globalHeads[name]];
+                if (entry.order < visibleGlobals) return &entry.symbol;
             }
         }
-        return nullptr;
+        return BuiltinSymbols::instance().find(name);
     }
 
 
-    // 调试：打印当前符号表
+    // 调试：输出当前符号表（Symbol 类别的 Debug 跟踪）
     void dump() const {
-        int level = scopes.size();
-        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it, --level) {
-            qDebug() << "Scope [" << level << "]: " << currentScopeName << "\n";
-            for (const auto& [name, sym] : *it) {
-                qDebug() << "  " << name << " : " << sym.type
-                          << (sym.is_function ? " (func)" : "") << "\n";
+        for (int level = getCurrentScope(); level >= 0; --level) {
+            TRACE(Symbol, Debug, "Scope [" << level + 1 << "]");
+            size_t end = level + 1 < static_cast<int>(scopeStarts.size()) ? scopeStarts[level + 1] : entries.size();
+            for (size_t i = scopeStarts[level]; i < end; ++i) {
+                const Symbol& sym = entries[i].symbol;
+                TRACE(Symbol, Debug, "  " << names.str(sym.name) << " : " << names.str(sym.type)
+                                          << (sym.is_function ? " (func)" : ""));
             }
         }
     }
-// 按名称和参数类型查找函数
-    Symbol* lookupFunction(const std::string& name, const std::vector<std::string>& argTypes) {
-        for (auto it = scopes.rbegin(); it != scopes.rend(); ++it) {
-            auto range = it->equal_range(name);
-            for (auto iter = range.first; iter != range.second; ++iter) {
-                if (iter->second.is_function) {
-                    // 比较参数类型
-                    if (argTypes.size() != iter->second.params.size()) continue;
-                    bool match = true;
-                    for (size_t i = 0; i < argTypes.size(); ++i) {
-                        if (argTypes[i] != iter->second.params[i].second) {
-                            match = false;
-                            break;
-                        }
-                    }
-                    if (match) return &iter->second;
-                }
-            }
+// 按名称和参数类型查找函数：用户定义的函数优先，其次是内置函数，各只需一次哈希查找
+    const Symbol* lookupFunction(int name, const std::vector<int>& argTypes) const {
+        probe.clear();
+        probe.push_back(name);
+        probe.insert(probe.end(), argTypes.begin(), argTypes.end());
+        const SymbolTable& owner = globals ? *globals : *this;
+        auto found = owner.functions.find(probe);
+        if (found != owner.functions.end() && found->second->order < visibleGlobals) {
+            return &found->second->symbol;
+        }
+        const FunctionIndex& builtins = BuiltinSymbols::instance().index;
+        auto builtin = builtins.find(probe);
+        return builtin != builtins.end() ? builtin->second : nullptr;
+    }
+    // 同名函数的个数（含内置函数），大于1表示存在重载
+    int overloadCount(int name) const {
+        const SymbolTable& owner = globals ? *globals : *this;
+        auto found = owner.overloadOrders.find(name);
+        int count = 0;
+        if (found != owner.overloadOrders.end()) {
+            const std::vector<int>& orders = found->second;
+            count = static_cast<int>(std::lower_bound(orders.begin(), orders.end(), visibleGlobals) - orders.begin());
         }
-        return nullptr;
+        return count + (BuiltinSymbols::instance().find(name) ? 1 : 0);
     }
-    int getScopeCount() const{return scopes.size();}
+    int getScopeCount() const{return scopeStarts.size();}
 private:
-    std::vector<std::unordered_map<std::string, Symbol>> scopes; // 作用域栈
-    std::vector<std::string> scopeNames;
-    std::string currentScopeName = "global"; // 当前作用域名
-    struct BuiltinFunction {
-        std::string name;          // 函数名
-        std::string return_type;   // 返回类型
-        std::vector<std::pair<std::string, std::string>> params; // 参数列表(名称-类型)
+    static constexpr int NONE = -1;
+    struct Entry {
+        Symbol symbol;
+        int shadowed;   // 被遮蔽的同名外层声明在 entries 中的下标，没有时为 NONE
+        int order;      // 全局声明的登记序号（局部符号不使用）
     };
-    void registerBuiltinFunctions() {
-        // 定义所有内置函数的元数据列表
-        const std::vector<BuiltinFunction> builtins = {
-            // IO函数
-            {"printf", "int", {{"format", "string"}, {"args", "vararg"}}},
-            {"scanf", "int", {{"format", "string"}, {"args", "vararg"}}},
-            {"puts", "int", {{"str", "string"}}},
-            {"gets", "string", {{"str", "string"}}},
-
-            // 字符串函数
-            {"strlen", "int", {{"str", "string"}}},
-            {"strcmp", "int", {{"str1", "string"}, {"str2", "string"}}},
-            {"strcpy", "string", {{"dest", "string"}, {"src", "string"}}},
-
-            // 数学函数
-            {"abs", "int", {{"num", "int"}}},
-            {"sqrt", "double", {{"num", "double"}}},
-            {"pow", "double", {{"base", "double"}, {"exponent", "double"}}}
-        };
-
-        // 批量注册函数到全局作用域
-        for (const auto& func : builtins) {
-            Symbol sym;
-            sym.name = func.name;
-            sym.type = func.return_type;
-            sym.is_function = true;
-            sym.scope = "global";
-            sym.params = func.params;
-            scopes.back().insert({sym.name, sym});
+    struct FunctionEntry {
+        Symbol symbol;
+        int order;
+    };
+
+    const StringInterner& names;
+    const SymbolTable* globals = nullptr;   // 分层符号表下面的全局符号表
+    int visibleGlobals = INT_MAX;           // 可见的全局声明个数（序号上限）
+    int declarationCount = 0;
+    std::deque<Entry> entries;          // 按声明顺序存放的符号（deque 保证 lookup 返回的指针在插入后仍有效）
+    std::vector<int> heads;             // 名字编号 -> 当前可见声明的下标
+    std::vector<size_t> scopeStarts;    // 每层作用域第一个符号在 entries 中的下标
+    std::deque<FunctionEntry> userFunctions;    // 用户定义的函数（含各个重载）
+    std::unordered_map<FunctionSignature, const FunctionEntry*, FunctionSignatureHash> functions;  // 用户函数的签名索引
+    std::unordered_map<int, std::vector<int>> overloadOrders;   // 函数名 -> 各个用户重载的登记序号（递增）
+    mutable FunctionSignature probe;    // lookupFunction 复用的查找键，避免每次调用分配
+
+    bool insertEntry(const Symbol& sym) {
+        if (scopeStarts.empty()) return false;
+        if (sym.name >= static_cast<int>(heads.size())) heads.resize(sym.name + 1, NONE);
+        int head = heads[sym.name];
+        if (head != NONE && static_cast<size_t>(head) >= scopeStarts.back()) {
+            return false; // 同一作用域重复声明
+        }
+        if (head == NONE && scopeStarts.size() == 1 && BuiltinSymbols::instance().find(sym.name)) {
+            return false; // 与全局作用域中的内置函数重名
         }
+        int order = declarationCount;
+        if (scopeStarts.size() == 1) ++declarationCount;
+        entries.push_back({sym, head, order});
+        heads[sym.name] = static_cast<int>(entries.size()) - 1;
+        return true;
+    }
+
+    bool insertFunction(const Symbol& sym) {
+        FunctionSignature signature = signatureOf(sym);
+        const FunctionIndex& builtins = BuiltinSymbols::instance().index;
+        if (functions.count(signature) || builtins.count(signature)) return false; // 签名完全相同：重复定义
+        std::vector<int>& orders = overloadOrders[sym.name];
+        int order = declarationCount;
+        // 第一个定义登记为普通符号，供 lookup() 按名字查找；内置函数的重载不再登记
+        if (orders.empty() && !BuiltinSymbols::instance().find(sym.name)) {
+            if (!insertEntry(sym)) return false;
+        } else {
+            ++declarationCount;
+        }
+        userFunctions.push_back({sym, order});
+        functions.emplace(std::move(signature), &userFunctions.back());
+        orders.push_back(order);
+        return true;
     }
 };
+#endif // SYMBOL_H
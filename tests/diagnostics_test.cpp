@@ -0,0 +1,44 @@
+// diagnostics_test.cpp
+// SARIF 输出中文件路径到 URI 的转换
+#include "diagnostics.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void expectUri(const std::string& path, const std::string& expected) {
+    std::string uri = pathToUri(path);
+    if (uri != expected) {
+        std::cerr << "pathToUri(\"" << path << "\") = \"" << uri << "\"，应为 \"" << expected << "\"\n";
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    // 相对路径：相对引用，':' 编码后不会被当作 scheme
+    expectUri("src/a.c", "src/a.c");
+    expectUri("src\\sub\\a.c", "src/sub/a.c");
+    expectUri("a:b.c", "a%3Ab.c");
+    expectUri("my file.c", "my%20file.c");
+
+    // 绝对路径：file: URI
+    expectUri("/home/x/a.c", "file:///home/x/a.c");
+    expectUri("C:\\src\\a.c", "file:///C:/src/a.c");
+    expectUri("d:/src/a b.c", "file:///d:/src/a%20b.c");
+    expectUri("\\\\server\\share\\a.c", "file://server/share/a.c");
+
+    // SARIF 文档中的 artifactLocation
+    std::ostringstream sarif;
+    writeDiagnosticsSarif(sarif, {{"C:\\src\\a.c", {{ErrorType::SYNTAX_ERROR, 1, 2, "x"}}}});
+    if (sarif.str().find("\"uri\":\"file:///C:/src/a.c\"") == std::string::npos) {
+        std::cerr << "SARIF 输出中没有盘符路径的 file: URI\n" << sarif.str() << '\n';
+        ++failures;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// highlightscan_test.cpp
+// 语法高亮的逐行扫描与 Lexer 一致：随机生成的代码片段逐行扫描（行末状态传给下一行）后，
+// 每个字符的高亮类别与按 Lexer 的Token推出的类别相同
+#include "compilation.h"
+#include "highlightscan.h"
+#include "lexer.h"
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using highlightscan::Kind;
+
+int failures = 0;
+
+// 字符的高亮类别，None 为不高亮（空白、运算符、标点、普通标识符）
+constexpr int None = -1;
+
+// 按 Lexer 的Token推出每个字节的类别：关键字、数字、字符串（含跨行的和未闭合的）直接对应Token；
+// Token 之间只有空白和注释，其中的注释即为注释；标识符之后的下一个Token是同一行的'('时为函数名
+std::vector<int> expectedKinds(const std::string& source) {
+    CompilationContext context;
+    Lexer lexer(context, source);
+    const std::vector<Token>& tokens = lexer.scanTokens();
+    std::vector<int> kinds(source.size(), None);
+    auto mark = [&kinds](size_t from, size_t to, Kind kind) {
+        for (size_t i = from; i < to; ++i) kinds[i] = static_cast<int>(kind);
+    };
+    auto markComments = [&](size_t from, size_t to) {
+        size_t i = from;
+        while (i < to) {
+            if (source.compare(i, 2, "//") == 0) {
+                size_t end = source.find_first_of("\r\n", i);
+                end = end == std::string::npos || end > to ? to : end;
+                mark(i, end, Kind::Comment);
+                i = end;
+            } else if (source.compare(i, 2, "/*") == 0) {
+                size_t end = source.find("*/", i + 2);
+                end = end == std::string::npos || end + 2 > to ? to : end + 2;
+                mark(i, end, Kind::Comment);
+                i = end;
+            } else {
+                ++i;
+            }
+        }
+    };
+
+    size_t previousEnd = 0;
+    for (size_t t = 0; t < tokens.size(); ++t) {
+        const Token& token = tokens[t];
+        size_t begin = token.offset;
+        size_t end = begin + token.length;
+        markComments(previousEnd, begin);
+        previousEnd = end;
+        switch (token.type) {
+        case TokenType::KEYWORD: mark(begin, end, Kind::Keyword); break;
+        case TokenType::NUMBER: mark(begin, end, Kind::Number); break;
+        case TokenType::STRING: mark(begin, end, Kind::String); break;
+        case TokenType::ERROR_TOKEN:
+            if (source[begin] == '"') mark(begin, end, Kind::String);
+            break;
+        case TokenType::IDENTIFIER:
+            if (t + 1 < tokens.size() && tokens[t + 1].type == TokenType::PUNCTUATOR &&
+                tokens[t + 1].value == "(" &&
+                source.find('\n', end) >= static_cast<size_t>(tokens[t + 1].offset)) {
+                mark(begin, end, Kind::Function);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    markComments(previousEnd, source.size());
+    // 换行符不属于任何一行，逐行扫描不会覆盖它
+    for (size_t i = 0; i < source.size(); ++i) {
+        if (source[i] == '\n') kinds[i] = None;
+    }
+    return kinds;
+}
+
+// 逐行调用 scanLine()，得到每个字节的类别；同时检查 endState() 与 scanLine() 的行末状态相同
+std::vector<int> scannedKinds(const std::string& source) {
+    std::vector<int> kinds(source.size(), None);
+    int state = -1;
+    size_t lineStart = 0;
+    while (lineStart <= source.size()) {
+        size_t lineEnd = source.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = source.size();
+        std::u16string line(source.begin() + lineStart, source.begin() + lineEnd);
+        int length = static_cast<int>(line.size());
+        int next = highlightscan::scanLine(line.data(), length, state, [&](int start, int count, Kind kind) {
+            for (int i = start; i < start + count; ++i) kinds[lineStart + i] = static_cast<int>(kind);
+        });
+        if (highlightscan::endState(line.data(), length, state) != next) {
+            std::cerr << "endState() 与 scanLine() 的行末状态不同：" << source.substr(lineStart, lineEnd - lineStart)
+                      << '\n';
+            ++failures;
+        }
+        state = next;
+        lineStart = lineEnd + 1;
+    }
+    return kinds;
+}
+
+// 片段之间随机用空格、换行或直接相连；块注释、字符串和行尾的反斜杠可以跨行
+std::string makeSource(std::mt19937& rng) {
+    static const char* const pieces[] = {
+        "int", "x", "foo", "(", ")", "if", "return", "while", "printf", "sizeof", "float2", "_if", "123", "4.5",
+        "6.", ".7", "8.9.0", "\"s\"", "\"a\\\"b\"", "\"open", "close\"", "\"\\", "/*", "*/", "//", "/", "*",
+        "=", "==", ";", "{", "}", ",", "+", "\t", "\r", "\xe4\xb8\xad",
+    };
+    static const char* const separators[] = {"", " ", "\n", "  "};
+    std::string source;
+    int count = 1 + rng() % 40;
+    for (int i = 0; i < count; ++i) {
+        source += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+        source += separators[rng() % (sizeof(separators) / sizeof(separators[0]))];
+    }
+    return source;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2024);
+    int reported = 0;
+    for (int round = 0; round < 20000; ++round) {
+        std::string source = makeSource(rng);
+        if (scannedKinds(source) != expectedKinds(source)) {
+            ++failures;
+            if (++reported <= 5) std::cerr << "高亮类别与 Lexer 不一致：\n" << source << "\n----\n";
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
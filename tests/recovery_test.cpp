@@ -0,0 +1,78 @@
+// recovery_test.cpp
+// 词法错误之后继续解析：无法识别的字符只报告一次，后面各行的语法和语义错误照常报告，
+// 完整模式、按需扫描模式和并行解析的结果相同
+#include "compilation.h"
+#include "lexer.h"
+#include "parser.h"
+#include "threadpool.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+enum class Mode { Buffered, Streaming, Parallel };
+
+std::vector<Error> compile(const std::string& source, Mode mode) {
+    CompilationContext context;
+    Lexer lexer(context, source);
+    ThreadPool pool(4);
+    if (mode == Mode::Streaming) {
+        lexer.enableStreaming();
+    } else {
+        lexer.scanTokens();
+        lexer.reset();
+    }
+    Parser parser(lexer);
+    if (mode == Mode::Parallel) {
+        parser.parse(pool);
+    } else {
+        parser.parse();
+    }
+    return context.errors().takeErrors();
+}
+
+struct Expected {
+    ErrorType type;
+    int line;
+    int column;
+};
+
+void expectErrors(const char* name, const std::string& source, const std::vector<Expected>& expected) {
+    for (Mode mode : {Mode::Buffered, Mode::Streaming, Mode::Parallel}) {
+        std::vector<Error> errors = compile(source, mode);
+        bool same = errors.size() == expected.size();
+        for (size_t i = 0; same && i < errors.size(); ++i) {
+            same = errors[i].type == expected[i].type && errors[i].line == expected[i].line &&
+                   errors[i].column == expected[i].column;
+        }
+        if (!same) {
+            std::cerr << name << "（模式 " << static_cast<int>(mode) << "）的错误与预期不同：\n";
+            for (const Error& error : errors) {
+                std::cerr << "  " << error.line << ':' << error.column << ' ' << error.message << '\n';
+            }
+            ++failures;
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    expectErrors("表达式中的无法识别的字符",
+                 "int main() {\n int a = 1;\n a = @;\n int b = ;\n c = 2;\n return 0;\n}\n",
+                 {{ErrorType::LEXICAL_ERROR, 3, 6},
+                  {ErrorType::SYNTAX_ERROR, 4, 10},
+                  {ErrorType::UNDEFINED_VARIABLE, 5, 2}});
+
+    // 同步停在下一条语句的开头，'#' 之后的声明照常登记
+    expectErrors("语句开头和函数之间的无法识别的字符",
+                 "int f() {\n # int a = 1;\n return a;\n}\n$\nint g() {\n return x;\n}\n",
+                 {{ErrorType::LEXICAL_ERROR, 2, 2},
+                  {ErrorType::LEXICAL_ERROR, 5, 1},
+                  {ErrorType::UNDEFINED_VARIABLE, 7, 9}});
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// threadpool.h
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程有自己的任务队列，按提交顺序取任务；自己的队列空了就从
+// 其他线程的队列窃取，窃取的也是最早提交的任务——调用方按预计耗时从大到小提交时，
+// 被窃走的总是剩下的最大任务，避免大任务压在某个忙碌线程的队列里拖长总耗时。
+// 外部线程提交的任务轮流分配到各队列；任务内部再提交的任务放进当前线程自己的队列。
+// 任务彼此独立、耗时在毫秒级以上（如一个文件的编译），每个队列用一把锁保护即可
+class ThreadPool {
+public:
+    // threadCount 为 0 时使用硬件线程数
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    // 等待已提交的任务全部完成；任务抛出的第一个异常在这里重新抛出。不能在任务内部调用
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, std::function<void()>& task);
+    bool steal(unsigned thief, std::function<void()>& task);
+    void run(std::function<void()>& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;                  // 保护下面两个条件变量的等待
+    std::condition_variable workAvailable;  // 有新任务或线程池析构
+    std::condition_variable allDone;        // unfinished 归零
+    std::atomic<size_t> queued{0};          // 还在队列中、未被取走的任务数
+    std::atomic<size_t> unfinished{0};      // 已提交但未执行完的任务数
+    std::atomic<unsigned> nextQueue{0};     // 外部提交时轮流选择的队列
+    bool stopping = false;
+
+    std::mutex errorMutex;
+    std::exception_ptr firstError;
+};
+
+#endif // THREADPOOL_H
@@ -3,6 +3,7 @@
 #define TOKEN_H
 
 #include <string>
+#include <string_view>
 
 enum class TokenType {
     KEYWORD,       // 关键字
@@ -11,14 +12,44 @@ enum class TokenType {
     OPERATOR,      // 运算符
     PUNCTUATOR,    // 标点符号
     STRING,        // 字符串
+    ERROR_TOKEN,   // 词法错误（无法识别的字符、未闭合的字符串），错误已由 Lexer 登记
     EOF_TOKEN      // 文件结束
 };
 
 std::string tokenTypeToString(TokenType type);
 
+// Token 只保存指向源码缓冲区（或词法分析器内部存储）的视图，复制时不分配内存；
+// 视图在产生它的 Lexer 生命周期内有效。行列号不随Token保存，需要时由 Lexer::location() 计算
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
+    int offset;     // 在源码中的起始字节偏移
+    int length;     // 在源码中占用的字节数（字符串字面量包含引号）
+    int id = -1;    // 标识符/关键字在驻留表中的编号，其它Token为-1
+};
+
+// Token 的值是否直接引用源码：标识符、关键字、数字和不含转义的字符串是；运算符、标点是字面量，
+// 含转义的字符串引用 Lexer 内部的解码结果（解码后比去掉引号的原文短）
+inline bool valueInSource(const Token& token) {
+    switch (token.type) {
+    case TokenType::IDENTIFIER:
+    case TokenType::KEYWORD:
+    case TokenType::NUMBER:
+        return true;
+    case TokenType::STRING:
+        return static_cast<int>(token.value.size()) == token.length - 2;
+    default:
+        return false;
+    }
+}
+
+// 直接引用源码时，值在源码中的起始偏移（字符串去掉开头的引号）
+inline int valueOffset(const Token& token) {
+    return token.type == TokenType::STRING ? token.offset + 1 : token.offset;
+}
+
+// 源码位置（行列号均从1开始，列按字节计）
+struct SourceLocation {
     int line;
     int column;
 };
@@ -0,0 +1,77 @@
+// trace.cpp
+#include "trace.h"
+#include <iostream>
+#include <mutex>
+
+namespace trace {
+
+namespace detail {
+std::atomic<unsigned> enabledCategories{0};
+std::atomic<int> enabledLevel{static_cast<int>(Level::Off)};
+} // namespace detail
+
+namespace {
+
+const char* categoryName(unsigned category) {
+    switch (category) {
+    case Lexer: return "lexer";
+    case Parser: return "parser";
+    case Symbol: return "symbol";
+    case Gui: return "gui";
+    default: return "trace";
+    }
+}
+
+void writeToStderr(unsigned category, Level, const std::string& message) {
+    std::cerr << "[" << categoryName(category) << "] " << message << '\n';
+}
+
+std::mutex sinkMutex;   // 多个线程同时输出时保证每条消息完整
+Sink currentSink = writeToStderr;
+
+} // namespace
+
+void enable(unsigned categories, Level level) {
+    detail::enabledCategories.store(categories, std::memory_order_relaxed);
+    detail::enabledLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+bool configure(std::string_view spec) {
+    Level level = Level::Debug;
+    size_t colon = spec.find(':');
+    if (colon != std::string_view::npos) {
+        std::string_view levelName = spec.substr(colon + 1);
+        if (levelName == "info") level = Level::Info;
+        else if (levelName == "debug") level = Level::Debug;
+        else if (levelName == "verbose") level = Level::Verbose;
+        else return false;
+        spec = spec.substr(0, colon);
+    }
+    unsigned mask = 0;
+    while (!spec.empty()) {
+        size_t comma = spec.find(',');
+        std::string_view name = spec.substr(0, comma);
+        if (name == "lexer") mask |= Lexer;
+        else if (name == "parser") mask |= Parser;
+        else if (name == "symbol") mask |= Symbol;
+        else if (name == "gui") mask |= Gui;
+        else if (name == "all") mask |= All;
+        else return false;
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+    }
+    if (mask == 0) return false;
+    enable(mask, level);
+    return true;
+}
+
+void setSink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    currentSink = sink ? sink : writeToStderr;
+}
+
+Line::~Line() {
+    std::lock_guard<std::mutex> lock(sinkMutex);
+    currentSink(category, level, stream.str());
+}
+
+} // namespace trace
@@ -0,0 +1,97 @@
+// trace.h
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+// 编译期可裁剪的调试跟踪：
+//   COMPILER_TRACE_LEVEL      编译进程序的最高级别（0 关闭全部，默认 2 即 Debug，逐 Token 的 Verbose 跟踪不编译）
+//   COMPILER_TRACE_CATEGORIES 编译进程序的类别掩码（默认全部）
+// 超出编译期范围的 TRACE 语句整体被 if constexpr 删除，不产生任何代码；
+// 编译进来的语句在运行时默认关闭，关闭时只有一次原子读和一次比较，消息本身不会求值。
+#ifndef COMPILER_TRACE_LEVEL
+#define COMPILER_TRACE_LEVEL 2
+#endif
+#ifndef COMPILER_TRACE_CATEGORIES
+#define COMPILER_TRACE_CATEGORIES 0xFFu
+#endif
+
+namespace trace {
+
+enum class Level : int {
+    Off = 0,
+    Info = 1,       // 每次编译几条：开始/结束、错误恢复
+    Debug = 2,      // 每个函数/声明一条
+    Verbose = 3,    // 每个 Token/节点一条
+};
+
+enum Category : unsigned {
+    Lexer = 1u << 0,
+    Parser = 1u << 1,
+    Symbol = 1u << 2,
+    Gui = 1u << 3,
+    All = 0xFFu,
+};
+
+// 编译期判断：该类别和级别的跟踪是否编译进程序
+constexpr bool compiledIn(unsigned category, Level level) {
+    return static_cast<int>(level) <= COMPILER_TRACE_LEVEL && (category & COMPILER_TRACE_CATEGORIES) != 0;
+}
+
+namespace detail {
+extern std::atomic<unsigned> enabledCategories;
+extern std::atomic<int> enabledLevel;
+} // namespace detail
+
+// 运行时开关：启用 categories 中不高于 level 的跟踪（Level::Off 即全部关闭）
+void enable(unsigned categories, Level level);
+// 按文本配置运行时开关，格式为 "类别[,类别...][:级别]"，如 "parser,symbol:verbose"；
+// 类别为 lexer/parser/symbol/gui/all，级别为 info/debug/verbose（缺省 debug）。格式错误时返回 false 且不做修改
+bool configure(std::string_view spec);
+
+inline bool enabled(unsigned category, Level level) {
+    return static_cast<int>(level) <= detail::enabledLevel.load(std::memory_order_relaxed) &&
+           (category & detail::enabledCategories.load(std::memory_order_relaxed)) != 0;
+}
+
+// 输出目标，默认写到标准错误；GUI 等可替换为自己的输出
+using Sink = void (*)(unsigned category, Level level, const std::string& message);
+void setSink(Sink sink);
+
+// 收集一条跟踪消息，析构时整行交给输出目标
+class Line {
+public:
+    Line(unsigned category, Level level) : category(category), level(level) {}
+    ~Line();
+    Line(const Line&) = delete;
+    Line& operator=(const Line&) = delete;
+
+    template <typename T>
+    Line& operator<<(const T& value) {
+        stream << value;
+        return *this;
+    }
+
+private:
+    unsigned category;
+    Level level;
+    std::ostringstream stream;
+};
+
+} // namespace trace
+
+// 用法: TRACE(Parser, Debug, "解析函数: " << name);
+// message 只在该跟踪已编译进程序且运行时开启时才求值
+#define TRACE(category, level, message)                                                        \
+    do {                                                                                       \
+        if constexpr (::trace::compiledIn(::trace::category, ::trace::Level::level)) {         \
+            if (::trace::enabled(::trace::category, ::trace::Level::level)) {                  \
+                ::trace::Line(::trace::category, ::trace::Level::level) << message;            \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+#endif // TRACE_H